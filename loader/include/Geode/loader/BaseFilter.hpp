@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+// The type-erased filters that event centers key their ports by. Only uses
+// the standard library, so that it can be tested on the host (see test/host)
+namespace geode::comm {
+    class OpaquePortBase {
+    public:
+        virtual ~OpaquePortBase() noexcept = default;
+    };
+
+    class BaseFilter {
+    public:
+        virtual ~BaseFilter() noexcept = default;
+        virtual bool operator==(BaseFilter const& other) const noexcept = 0;
+        virtual size_t hash() const noexcept = 0;
+        virtual BaseFilter* clone() const noexcept = 0;
+        virtual OpaquePortBase* getPort() const noexcept = 0;
+    };
+
+    class BaseFilterHash {
+    public:
+        size_t operator()(BaseFilter const* filter) const noexcept {
+            return filter->hash();
+        }
+        size_t operator()(std::shared_ptr<BaseFilter> const& filter) const noexcept {
+            return filter->hash();
+        }
+
+        using is_transparent = void;
+    };
+
+    // Stored keys are shared_ptrs, lookups may probe with a raw pointer to a
+    // filter view (see BasicEvent::View). The standard library may pass the
+    // two in either order, and only the probe's operator== is guaranteed to
+    // understand the other: keys added by mods built against older headers
+    // don't know about views. So the mixed overloads always ask the probe
+    class BaseFilterEqual {
+    public:
+        bool operator()(std::shared_ptr<BaseFilter> const& a, std::shared_ptr<BaseFilter> const& b) const noexcept {
+            return *a == *b;
+        }
+        bool operator()(BaseFilter const* a, std::shared_ptr<BaseFilter> const& b) const noexcept {
+            return *a == *b;
+        }
+        bool operator()(std::shared_ptr<BaseFilter> const& a, BaseFilter const* b) const noexcept {
+            return *b == *a;
+        }
+        bool operator()(BaseFilter const* a, BaseFilter const* b) const noexcept {
+            return *a == *b;
+        }
+        using is_transparent = void;
+    };
+}
@@ -11,6 +11,8 @@
 #include <tuple>
 
 namespace geode {
+    // To send without allocating the event ID, use a view:
+    // Dispatch<int>::view("my-mod/my-event").send(5);
     template <class... Args>
     class Dispatch : public ThreadSafeEvent<Dispatch<Args...>, bool(Args...), std::string> {
     public:
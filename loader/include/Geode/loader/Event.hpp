@@ -2,6 +2,7 @@
 
 #include <any>
 #include <vector>
+#include <unordered_map>
 #include <concepts>
 #include <functional>
 #include <variant>
@@ -10,11 +11,21 @@
 #include <algorithm>
 #include <mutex>
 #include <atomic>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <typeinfo>
 #include <asp/ptr/PtrSwap.hpp>
 #include <asp/iter.hpp>
 #include "../utils/function.hpp"
 #include "../utils/casts.hpp"
 #include "../utils/hash.hpp"
+#include "../utils/MPSCQueue.hpp"
+#include "BaseFilter.hpp"
+#include "PortReceivers.hpp"
+#include "EventProfiler.hpp"
+#include "Watchdog.hpp"
 // #include "../utils/ZStringView.hpp"
 // #include "Types.hpp"
 
@@ -22,6 +33,11 @@
 //     void log(ZStringView msg, Severity severity);
 // }
 
+namespace geode {
+    class Mod;
+    Mod* getMod();
+}
+
 namespace geode::comm {
     template <class T>
     struct RefOrVoid {
@@ -34,7 +50,11 @@ namespace geode::comm {
     template <class T>
     using RefOrVoidType = typename RefOrVoid<T>::type;
 
-    using ReceiverHandle = size_t;
+    // Version of the opaque port layout a caller was compiled against.
+    // The event centers remember which version each stored port was last
+    // checked against, so the migration check only runs when a port is
+    // created or first touched by a newer caller, instead of on every send.
+    using PortVersion = uint32_t;
 
     template <class Port>
     concept IsPort = requires(Port p, typename Port::CallableType c, ReceiverHandle h) {
@@ -80,66 +100,157 @@ namespace geode::comm {
 
     class EventCenterThreadLocal;
     class EventCenterGlobal;
+    struct EventCenterPerThread;
+
+    // The mod that added each receiver, for hitch reports and the event
+    // profiler. Kept by the loader, keyed by port and handle, since ports
+    // can't gain members (see below). The table takes a lock, so owners are
+    // only recorded while the watchdog is enabled or the event profiler is
+    // built in. Receivers added before that, or by mods built against older
+    // headers, have no owner
+    GEODE_DLL void setReceiverOwner(void const* port, ReceiverHandle handle, Mod* owner) noexcept;
+    GEODE_DLL void removeReceiverOwner(void const* port, ReceiverHandle handle) noexcept;
+    // Forgets every owner of a port if to is null
+    GEODE_DLL void moveReceiverOwners(void const* from, void const* to) noexcept;
+    GEODE_DLL Mod* getReceiverOwner(void const* port, ReceiverHandle handle) noexcept;
+
+    namespace detail {
+        // Set by the loader once the first owner is recorded. Until then
+        // removing receivers and destroying ports skip the table
+        GEODE_DLL extern std::atomic_bool hasReceiverOwners;
+
+        inline bool recordsReceiverOwners() noexcept {
+        #ifdef GEODE_EVENT_PROFILER
+            return true;
+        #else
+            return watchdog::isEnabled();
+        #endif
+        }
+
+        inline void addReceiverOwner(void const* port, ReceiverHandle handle) noexcept {
+            if (recordsReceiverOwners()) {
+                setReceiverOwner(port, handle, geode::getMod());
+            }
+        }
+
+        inline void dropReceiverOwner(void const* port, ReceiverHandle handle) noexcept {
+            if (hasReceiverOwners.load(std::memory_order_relaxed)) {
+                removeReceiverOwner(port, handle);
+            }
+        }
+
+        inline void moveReceiverOwners(void const* from, void const* to) noexcept {
+            if (hasReceiverOwners.load(std::memory_order_relaxed)) {
+                comm::moveReceiverOwners(from, to);
+            }
+        }
+    }
 
     // Okay so even though the Event system is fully header only,
     // we can still version it. One caveat/hackiness is that
     // Ports should be backwards ABI compatible, meaning no member
     // reordering or removing, but we can add new members at the end.
+    // Only at the end of the port types nothing derives from though:
+    // Port is the base of OncePort and QueuedPort, so anything added to
+    // it would move their members, and has to live in the loader instead.
     // For every new version, we need to add a migration system
     // for the previous version, which is basically just a function
     // that moves the data. Continue reading from OpaqueEventPort.
     template <class Callable, bool ThreadSafe=false, template <class> class Container = PortCallableCopy>
     class Port {
     protected:
+        // Receivers in priority order. This is the list that gets sent to,
+        // also by mods built against older headers, which have their own
+        // copy of send inlined, so everything has to end up in here.
         std::vector<Container<Callable>> m_receivers;
+        // Removed and added while sending, applied once the outermost send
+        // finishes. Older mods apply these too
         std::vector<typename std::vector<Container<Callable>>::iterator> m_toRemove;
         std::vector<Container<Callable>> m_toAdd;
         size_t m_nextID = 1;
         size_t m_sending = 0;
+
+        using Iterator = typename std::vector<Container<Callable>>::iterator;
+
+        void flushPending() noexcept {
+            // geode::console::log(fmt::format("Flushing {} handlers from toRemove", m_toRemove.size()), Severity::Debug);
+            receivers::erase(m_receivers, m_toRemove);
+
+            // geode::console::log(fmt::format("Flushing {} handlers from toAdd", m_toAdd.size()), Severity::Debug);
+            for (auto& receiver : m_toAdd) {
+                m_receivers.insert(receivers::insertPosition(m_receivers, receiver.m_priority), std::move(receiver));
+            }
+            m_toAdd.clear();
+        }
+
+        // Calls every receiver in priority order until one returns true
+        template <class Call>
+        bool forEachReceiver(Call&& call) {
+            auto watching = watchdog::isActive();
+            receivers::PendingRemovals<Iterator> removed(m_toRemove);
+            for (auto it = m_receivers.begin(); it != m_receivers.end(); ++it) {
+                if (removed.contains(it)) {
+                    continue;
+                }
+                GEODE_EVENT_PROFILE_RECEIVER(this, *it);
+                // labeled with the event by the scope around the send
+                watchdog::Scope scope(watching, watching ? getReceiverOwner(this, it->m_handle) : nullptr, nullptr);
+                if (call(*it)) return true;
+            }
+            return false;
+        }
+
     public:
         using CallableType = Callable;
         using EventCenterType = EventCenterThreadLocal;
 
+        Port() = default;
+        ~Port() noexcept {
+            detail::moveReceiverOwners(this, nullptr);
+        }
+
         void migrateFromV1(Port&& other) noexcept {
             m_receivers = std::move(other.m_receivers);
             other.m_receivers.clear();
+            detail::moveReceiverOwners(&other, this);
         }
 
         ReceiverHandle addReceiver(Callable receiver, int priority = 0) noexcept {
             ReceiverHandle handle = static_cast<ReceiverHandle>(m_nextID++);
+            detail::addReceiverOwner(this, handle);
             if (m_sending > 0) {
                 // geode::console::log(fmt::format("Added handler with id {} to toAdd", handle), Severity::Debug);
                 m_toAdd.push_back({std::move(receiver), priority, handle});
                 return handle;
             }
-            for (auto it = m_receivers.begin(); it != m_receivers.end(); ++it) {
-                if (priority < it->m_priority) {
-                    // geode::console::log(fmt::format("Added handler with id {} to receivers", handle), Severity::Debug);
-                    m_receivers.insert(it, {std::move(receiver), priority, handle});
-                    return handle;
-                }
-            }
-            m_receivers.push_back({std::move(receiver), priority, handle});
+            // after every receiver with the same priority, so those are
+            // called in the order they were added
+            // geode::console::log(fmt::format("Added handler with id {} to receivers", handle), Severity::Debug);
+            m_receivers.insert(receivers::insertPosition(m_receivers, priority), {std::move(receiver), priority, handle});
             return handle;
         }
 
         size_t removeReceiver(ReceiverHandle handle) noexcept {
-            auto size = m_receivers.size();
-            for (int i = 0; i < size; ++i) {
-                if (m_receivers[i].m_handle == handle) {
-                    if (m_sending > 0) {
-                        // geode::console::log(fmt::format("Added handler with id {} to toRemove", handle), Severity::Debug);
-                        m_toRemove.push_back(m_receivers.begin() + i);
-                    } else {
-                        // geode::console::log(fmt::format("Removed handler with id {} from receivers", handle), Severity::Debug);
-                        m_receivers.erase(m_receivers.begin() + i);
+            detail::dropReceiverOwner(this, handle);
+            auto it = receivers::find(m_receivers, handle);
+            if (it != m_receivers.end()) {
+                if (m_sending > 0) {
+                    // geode::console::log(fmt::format("Added handler with id {} to toRemove", handle), Severity::Debug);
+                    if (!receivers::PendingRemovals<Iterator>(m_toRemove).contains(it)) {
+                        m_toRemove.push_back(it);
                     }
-                    // size - 1, return for symmetry
-                    return size - 1;
+                } else {
+                    // geode::console::log(fmt::format("Removed handler with id {} from receivers", handle), Severity::Debug);
+                    m_receivers.erase(it);
                 }
             }
-            // size
-            return size;
+            else {
+                // added by a send that hasn't finished yet
+                std::erase_if(m_toAdd, [&](auto const& r) {
+                    return r.m_handle == handle;
+                });
+            }
+            return this->getReceiverCount();
         }
 
         size_t getReceiverCount() const noexcept {
@@ -150,38 +261,39 @@ namespace geode::comm {
         requires std::invocable<Callable, Args...>
         bool send(Args&&... value) noexcept(std::is_nothrow_invocable_v<Callable, Args...>) {
             m_sending++;
-            bool ret = false;
-            for (auto& callable : m_receivers) {
-                if (std::find_if(m_toRemove.begin(), m_toRemove.end(), [&callable](auto& it) {
-                    return it->m_handle == callable.m_handle;
-                }) != m_toRemove.end()) {
-                    // geode::console::log(fmt::format("Skipping handler with id {} because it is in toRemove", callable.m_handle), Severity::Debug);
-                    continue;
-                }
-                if (callable.call(value...)) {
-                    ret = true;
-                    break;
-                }
-            }
+            bool ret = this->forEachReceiver([&](auto& receiver) {
+                return receiver.call(value...);
+            });
             m_sending--;
 
             if (m_sending == 0) {
-                // geode::console::log(fmt::format("Flushing {} handlers from toRemove", m_toRemove.size()), Severity::Debug);
-                std::sort(m_toRemove.rbegin(), m_toRemove.rend());
-                for (auto& it : m_toRemove) {
-                    m_receivers.erase(it);
-                }
-                m_toRemove.clear();
+                this->flushPending();
+            }
+
+            return ret;
+        }
 
-                // geode::console::log(fmt::format("Flushing {} handlers from toAdd", m_toAdd.size()), Severity::Debug);
-                m_receivers.insert(m_receivers.end(), std::make_move_iterator(m_toAdd.begin()), std::make_move_iterator(m_toAdd.end()));
-                m_toAdd.clear();
-                std::sort(m_receivers.begin(), m_receivers.end(), [](auto& a, auto& b) {
-                    return a.m_priority < b.m_priority;
+        // Sends every payload in order, calling onStop with the index of each
+        // payload a receiver stopped. The whole batch counts as one send, so
+        // receivers added or removed by a receiver take effect after the batch.
+        template <class Payload, class OnStop>
+        void sendBatch(std::span<Payload> payloads, OnStop&& onStop) noexcept(std::is_nothrow_invocable_v<Callable, Payload&>) {
+            m_sending++;
+            for (size_t i = 0; i < payloads.size(); ++i) {
+                auto stop = this->forEachReceiver([&](auto& receiver) {
+                    return std::apply([&](auto&... value) {
+                        return receiver.call(value...);
+                    }, payloads[i]);
                 });
+                if (stop) {
+                    onStop(i);
+                }
             }
+            m_sending--;
 
-            return ret;
+            if (m_sending == 0) {
+                this->flushPending();
+            }
         }
     };
 
@@ -194,11 +306,20 @@ namespace geode::comm {
         using EventCenterType = EventCenterGlobal;
 
         Port() : m_receivers(asp::make_shared<VectorType>()) {}
+        ~Port() noexcept {
+            detail::moveReceiverOwners(this, nullptr);
+        }
 
         void migrateFromV1(Port&& other) noexcept {
             m_receivers.store(other.m_receivers.load());
+            detail::moveReceiverOwners(&other, this);
         }
 
+        // Adding and removing copy every receiver, so that sends never have
+        // to lock. That makes both O(n) no matter how the copy is searched.
+        // The handle is one past the largest one for the same reason older
+        // mods do it: a counter would have to be a new member, which would
+        // move the members of OncePort and QueuedPort
         ReceiverHandle addReceiver(Callable receiver, int priority = 0) noexcept {
             ReceiverHandle handle = {};
             m_receivers.rcu([&](auto const& ptr) {
@@ -209,16 +330,12 @@ namespace geode::comm {
                     .max()
                     .value_or(0) + 1;
 
-                for (auto it = newReceivers->begin(); it != newReceivers->end(); ++it) {
-                    if (priority < it->m_priority) {
-                        newReceivers->insert(it, {std::move(receiver), priority, handle});
-                        return newReceivers;
-                    }
-                }
-                newReceivers->push_back({std::move(receiver), priority, handle});
+                // after every receiver with the same priority
+                newReceivers->insert(receivers::insertPosition(*newReceivers, priority), {receiver, priority, handle});
                 return newReceivers;
             });
 
+            detail::addReceiverOwner(this, handle);
             return handle;
         }
 
@@ -226,16 +343,15 @@ namespace geode::comm {
             size_t size = 0;
             m_receivers.rcu([&](auto const& ptr) {
                 auto newReceivers = asp::make_shared<VectorType>(*ptr.get());
-                size = newReceivers->size();
-                for (int i = 0; i < size; ++i) {
-                    if ((*newReceivers)[i].m_handle == handle) {
-                        newReceivers->erase(newReceivers->begin() + i);
-                        size--;
-                        return newReceivers;
-                    }
+                auto it = receivers::find(*newReceivers, handle);
+                if (it != newReceivers->end()) {
+                    newReceivers->erase(it);
                 }
+                size = newReceivers->size();
                 return newReceivers;
             });
+
+            detail::dropReceiverOwner(this, handle);
             return size;
         }
 
@@ -247,23 +363,56 @@ namespace geode::comm {
         requires std::invocable<Callable, Args...>
         bool send(Args&&... value) noexcept(std::is_nothrow_invocable_v<Callable, Args...>) {
             auto currentReceivers = m_receivers.load();
+            auto watching = watchdog::isActive();
             for (auto& callable : *currentReceivers) {
+                GEODE_EVENT_PROFILE_RECEIVER(this, callable);
+                watchdog::Scope scope(watching, watching ? getReceiverOwner(this, callable.m_handle) : nullptr, nullptr);
                 if (callable.call(value...)) {
                     return true;
                 }
             }
             return false;
         }
+
+        // Every payload is sent to the same snapshot of receivers
+        template <class Payload, class OnStop>
+        void sendBatch(std::span<Payload> payloads, OnStop&& onStop) noexcept(std::is_nothrow_invocable_v<Callable, Payload&>) {
+            auto currentReceivers = m_receivers.load();
+            auto watching = watchdog::isActive();
+            for (size_t i = 0; i < payloads.size(); ++i) {
+                for (auto& callable : *currentReceivers) {
+                    GEODE_EVENT_PROFILE_RECEIVER(this, callable);
+                    watchdog::Scope scope(watching, watching ? getReceiverOwner(this, callable.m_handle) : nullptr, nullptr);
+                    auto stop = std::apply([&](auto&... value) {
+                        return callable.call(value...);
+                    }, payloads[i]);
+                    if (stop) {
+                        onStop(i);
+                        break;
+                    }
+                }
+            }
+        }
+    };
+
+    // A non thread-safe port whose event is delivered per thread,
+    // see EventCenterThreadLocal::getForCurrentThread
+    template <class Callable, bool ThreadSafe = false, template <class> class Container = PortCallableCopy>
+    class ThreadLocalPort : public Port<Callable, false, Container> {
+        static_assert(!ThreadSafe, "ThreadLocalPort can't be thread safe, use Port<Callable, true> instead");
+    public:
+        using EventCenterType = EventCenterPerThread;
     };
 
     template <class Callable, bool ThreadSafe = false>
     class OncePort : protected Port<Callable, ThreadSafe, PortCallableMove> {
+        using Base = Port<Callable, ThreadSafe, PortCallableMove>;
         std::conditional_t<ThreadSafe, std::atomic_flag, bool> m_sent = false;
     public:
         using CallableType = Callable;
 
-        using Port<Callable, ThreadSafe>::addReceiver;
-        using Port<Callable, ThreadSafe>::removeReceiver;
+        using Base::addReceiver;
+        using Base::removeReceiver;
 
         template <class ...Args>
         bool send(Args&&... args) noexcept(std::is_nothrow_invocable_v<Callable, Args...>) {
@@ -276,7 +425,7 @@ namespace geode::comm {
                 m_sent = true;
             }
 
-            return Port<Callable, ThreadSafe>::send(std::forward<Args>(args)...);
+            return Base::send(std::forward<Args>(args)...);
         }
         bool isSent() const noexcept {
             if constexpr (ThreadSafe)
@@ -286,63 +435,104 @@ namespace geode::comm {
         }
     };
 
-    template <class Callable, bool ThreadSafe = false, template <class> class Container = PortCallableCopy>
-    class QueuedPort : protected Port<Callable, ThreadSafe, Container> {
+    // The members QueuedPort had before the lock-free queue, which are all
+    // that mods built against older headers know about. QueuedOncePort builds
+    // on this instead of on QueuedPort, so that its own member stays right
+    // after these and the lock-free queue can go at the end of both
+    template <class Callable, bool ThreadSafe, template <class> class Container>
+    class QueuedPortBase : protected Port<Callable, ThreadSafe, Container> {
+    protected:
+        using Base = Port<Callable, ThreadSafe, Container>;
         using VectorType = std::vector<geode::CopyableFunction<void()>>;
+        // In the thread safe variant, only older mods push to this one
         std::conditional_t<ThreadSafe, asp::PtrSwap<VectorType>, VectorType> m_queue;
-    public:
-        using CallableType = Callable;
 
-        using Port<Callable, ThreadSafe>::addReceiver;
-        using Port<Callable, ThreadSafe>::removeReceiver;
+        // The thread safe variant pushes to a lock-free queue instead, so
+        // pushing from worker threads is O(1), and flush takes the whole
+        // batch at once
+        using PendingType = std::conditional_t<ThreadSafe, utils::MPSCQueue<geode::Function<void()>>, std::monostate>;
 
         template <class ...Args>
-        requires std::invocable<Callable, Args...>
-        bool send(Args&&... args) noexcept(std::is_nothrow_invocable_v<Callable, Args...>) {
+        void enqueue(PendingType& pending, Args&&... args) {
+        #ifdef GEODE_EVENT_PROFILER
+            // attribute the delivery to the event that queued it
+            auto lam = [=, this, eventType = profiler::currentEvent()] {
+                profiler::SendScope scope(eventType, false);
+                return Base::send(args...);
+            };
+        #else
             auto lam = [=, this] {
-                return Port<Callable, ThreadSafe>::send(args...);
+                return Base::send(args...);
             };
+        #endif
 
             if constexpr (ThreadSafe) {
-                m_queue.rcu([&](auto const& ptr) {
-                    auto newQueue = asp::make_shared<VectorType>(*ptr.get());
-                    newQueue->push_back(lam);
-                    return newQueue;
-                });
+                pending.push(std::move(lam));
             } else {
-                m_queue.push_back(lam);
+                m_queue.push_back(std::move(lam));
             }
-            return false;
         }
 
-        void flush() noexcept {
+        // In the thread safe variant, only one thread should be flushing at a time
+        // for events to be delivered in order. Events queued during a flush are
+        // delivered on the next one. Events queued by older mods are delivered
+        // before the others, so only the events of each are in order.
+        void flushQueue(PendingType& pending) noexcept {
             if constexpr (ThreadSafe) {
-                m_queue.rcu([&](auto const& ptr) {
-                    auto newQueue = asp::make_shared<VectorType>(*ptr.get());
-                    for (auto& q : *newQueue) {
+                if (auto queue = m_queue.load(); queue && !queue->empty()) {
+                    m_queue.rcu([&](auto const& ptr) {
+                        queue = ptr;
+                        return asp::make_shared<VectorType>();
+                    });
+                    for (auto& q : *queue) {
                         std::invoke(q);
                     }
-                    newQueue->clear();
-                    return newQueue;
+                }
+                pending.drain([](geode::Function<void()>& q) {
+                    std::invoke(q);
                 });
             } else {
-                for (auto& q : m_queue) {
+                auto queue = std::move(m_queue);
+                m_queue.clear();
+                for (auto& q : queue) {
                     std::invoke(q);
                 }
-                m_queue.clear();
             }
         }
     };
 
+    template <class Callable, bool ThreadSafe = false, template <class> class Container = PortCallableCopy>
+    class QueuedPort : protected QueuedPortBase<Callable, ThreadSafe, Container> {
+        using Base = QueuedPortBase<Callable, ThreadSafe, Container>;
+        GEODE_NO_UNIQUE_ADDRESS typename Base::PendingType m_pending;
+    public:
+        using CallableType = Callable;
+
+        using Base::addReceiver;
+        using Base::removeReceiver;
+
+        template <class ...Args>
+        requires std::invocable<Callable, Args...>
+        bool send(Args&&... args) noexcept(std::is_nothrow_invocable_v<Callable, Args...>) {
+            this->enqueue(m_pending, std::forward<Args>(args)...);
+            return false;
+        }
+
+        void flush() noexcept {
+            this->flushQueue(m_pending);
+        }
+    };
+
     template <class Callable, bool ThreadSafe = false>
-    class QueuedOncePort : protected QueuedPort<Callable, ThreadSafe, PortCallableMove> {
+    class QueuedOncePort : protected QueuedPortBase<Callable, ThreadSafe, PortCallableMove> {
+        using Base = QueuedPortBase<Callable, ThreadSafe, PortCallableMove>;
         std::conditional_t<ThreadSafe, std::atomic_flag, bool> m_sent = false;
+        GEODE_NO_UNIQUE_ADDRESS typename Base::PendingType m_pending;
     public:
         using CallableType = Callable;
 
-        using QueuedPort<Callable, ThreadSafe>::addReceiver;
-        using QueuedPort<Callable, ThreadSafe>::removeReceiver;
-        using QueuedPort<Callable, ThreadSafe>::flush;
+        using Base::addReceiver;
+        using Base::removeReceiver;
 
         template <class ...Args>
         bool send(Args&&... args) noexcept(std::is_nothrow_invocable_v<Callable, Args...>) {
@@ -353,7 +543,8 @@ namespace geode::comm {
                 if (m_sent) return false;
                 m_sent = true;
             }
-            return QueuedPort<Callable, ThreadSafe>::send(std::forward<Args>(args)...);
+            this->enqueue(m_pending, std::forward<Args>(args)...);
+            return false;
         }
         bool isSent() const noexcept {
             if constexpr (ThreadSafe)
@@ -361,6 +552,10 @@ namespace geode::comm {
             else
                 return m_sent;
         }
+
+        void flush() noexcept {
+            this->flushQueue(m_pending);
+        }
     };
 
     template <template <class, bool, template <class> class> class PortType, bool ThreadSafe, template <class> class Container>
@@ -373,11 +568,6 @@ namespace geode::comm {
 
     class EventCenter;
 
-    class OpaquePortBase {
-    public:
-        virtual ~OpaquePortBase() noexcept = default;
-    };
-
     template <template <class> class PortTemplate, class... PArgs>
     requires PortTemplateFor<PortTemplate, geode::CopyableFunction<bool(PArgs...)>>
     class OpaqueEventPortV2;
@@ -405,6 +595,21 @@ namespace geode::comm {
             return m_port.send(std::forward<Args>(args)...);
         }
 
+        template <class OnStop>
+        void sendBatch(std::span<std::tuple<PArgs...>> payloads, OnStop&& onStop) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<bool(PArgs...)>, PArgs...>) {
+            if constexpr (requires { m_port.sendBatch(payloads, onStop); }) {
+                m_port.sendBatch(payloads, onStop);
+            }
+            else {
+                for (size_t i = 0; i < payloads.size(); ++i) {
+                    auto stop = std::apply([&](auto&... args) {
+                        return m_port.send(args...);
+                    }, payloads[i]);
+                    if (stop) onStop(i);
+                }
+            }
+        }
+
         ReceiverHandle addReceiver(geode::CopyableFunction<bool(PArgs...)> rec, int priority = 0) noexcept {
             return m_port.addReceiver(std::move(rec), priority);
         }
@@ -424,6 +629,8 @@ namespace geode::comm {
     requires PortTemplateFor<PortTemplate, geode::CopyableFunction<bool(PArgs...)>>
     class OpaqueEventPortV2 : public OpaqueEventPort<PortTemplate, PArgs...> {
     public:
+        static constexpr PortVersion Version = 2;
+
         OpaqueEventPortV2() {}
         ~OpaqueEventPortV2() noexcept override {}
 
@@ -432,43 +639,23 @@ namespace geode::comm {
         }
     };
 
-    class BaseFilter {
-    public:
-        virtual ~BaseFilter() noexcept = default;
-        virtual bool operator==(BaseFilter const& other) const noexcept = 0;
-        virtual size_t hash() const noexcept = 0;
-        virtual BaseFilter* clone() const noexcept = 0;
-        virtual OpaquePortBase* getPort() const noexcept = 0;
+    // How a filter value is held by a non-owning filter view, see BasicEvent::View.
+    // std::hash gives the same result for a string and its string_view, so a view
+    // hashes the same as the owning filter.
+    template <class T>
+    struct FilterViewOf {
+        using type = T;
     };
-
-    class BaseFilterHash {
-    public:
-        size_t operator()(BaseFilter const* filter) const noexcept {
-            return filter->hash();
-        }
-        size_t operator()(std::shared_ptr<BaseFilter> const& filter) const noexcept {
-            return filter->hash();
-        }
-
-        using is_transparent = void;
+    template <>
+    struct FilterViewOf<std::string> {
+        using type = std::string_view;
     };
+    template <class T>
+    using FilterViewType = typename FilterViewOf<T>::type;
 
-    class BaseFilterEqual {
-    public:
-        bool operator()(std::shared_ptr<BaseFilter> const& a, std::shared_ptr<BaseFilter> const& b) const noexcept {
-            return *a == *b;
-        }
-        bool operator()(BaseFilter const* a, std::shared_ptr<BaseFilter> const& b) const noexcept {
-            return *a == *b;
-        }
-        bool operator()(std::shared_ptr<BaseFilter> const& a, BaseFilter const* b) const noexcept {
-            return *a == *b;
-        }
-        bool operator()(BaseFilter const* a, BaseFilter const* b) const noexcept {
-            return *a == *b;
-        }
-        using is_transparent = void;
-    };
+    // Marker of the event batch listeners are registered on, see BasicEvent::listenBatch
+    template <class Marker>
+    struct BatchMarker {};
 
     template<class Marker, template <class> class PortTemplate, class Func, class... FArgs>
     class BasicEvent {
@@ -566,9 +753,12 @@ namespace geode::comm {
         using OpaqueEventV2Type = OpaqueEventPortV2<PortTemplate, PArgs...>;
         using LatestOpaqueEventType = OpaqueEventV2Type;
         using EventCenterType = LatestOpaqueEventType::EventCenterType;
+        static constexpr PortVersion LatestPortVersion = LatestOpaqueEventType::Version;
 
         // Here we migrate the port version if needed. This is what I meant by versioning,
         // we need to check for previous versions and move them into the current version.
+        // The event centers only call this when the stored port hasn't been checked
+        // against LatestPortVersion yet, so it stays off the send path.
         // Go to getPort definition.
         static OpaquePortBase* migratePort(OpaquePortBase* port) {
             if (!geode::cast::typeinfo_cast<OpaqueEventV2Type*>(port)) {
@@ -590,7 +780,12 @@ namespace geode::comm {
             // geode::console::log(fmt::format("Self type: {}", cast::getRuntimeTypeName(this)), Severity::Debug);
             // geode::console::log(fmt::format("Other type: {}", cast::getRuntimeTypeName(&other)), Severity::Debug);
             auto* o = geode::cast::typeinfo_cast<Self const*>(&other);
-            if (!o) return false;
+            if (!o) {
+                if (auto view = geode::cast::typeinfo_cast<View const*>(&other)) {
+                    return view->operator==(*this);
+                }
+                return false;
+            }
 
             auto ret = m_filter == o->m_filter;
 
@@ -618,6 +813,10 @@ namespace geode::comm {
         ListenerHandle addReceiver(geode::CopyableFunction<PReturn(PArgs...)> rec, int priority = 0) const noexcept;
         size_t removeReceiver(ReceiverHandle handle) const noexcept;
 
+        // Shared by the event and its views, filter hashes and compares the same as a Self
+        static bool sendTo(BaseFilter const* filter, PArgs... args) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>);
+        static size_t getReceiverCountOf(BaseFilter const* filter) noexcept;
+
         static void removeReceiverStatic(BaseFilter const* filter, ReceiverHandle handle) noexcept {
             auto* self = static_cast<BasicEvent const*>(filter);
             // geode::console::log(fmt::format("Static removing receiver from BasicEvent {}, {}", (void*)self, typeid(Marker).name()), Severity::Debug);
@@ -641,8 +840,175 @@ namespace geode::comm {
 
         bool send(PArgs... args) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>);
 
+        using Payload = std::tuple<PArgs...>;
+        using BatchEventType = BasicEvent<BatchMarker<Marker>, PortTemplate, bool(std::span<Payload>), FArgs...>;
+
+        /**
+         * Send many payloads to this filter in one go. The port is only looked
+         * up once, and the receivers are walked as if it was one send, so
+         * receivers added or removed while sending take effect after the batch.
+         * Listeners registered with listenBatch get the whole span first, and
+         * if one of them stops propagation, nobody else receives the batch.
+         * @returns The number of payloads whose propagation was stopped
+         */
+        size_t sendBatch(std::span<Payload> payloads) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>);
+
+        /**
+         * Listen for batches sent with sendBatch as a whole, instead of one
+         * call per payload. Batch listeners don't receive events sent with send
+         */
+        template <class Callable>
+        requires std::is_invocable_v<Callable, std::span<Payload>>
+        ListenerHandle listenBatch(Callable listener, int priority = 0) const noexcept {
+            return std::apply([&](auto const&... fargs) {
+                return BatchEventType(fargs...).listen(std::move(listener), priority);
+            }, m_filter);
+        }
+
         size_t getReceiverCount() const noexcept;
 
+        /**
+         * A sender bound to the port of a specific filter. The filter is only
+         * looked up when the sender is created, or when the port it was bound
+         * to has been removed or replaced, so repeatedly sending the same event
+         * (e.g. every frame) skips constructing and hashing the filter.
+         * A sender remembers which event center it found the port in, and
+         * looks the port up again when it's used with a different one, e.g.
+         * from another thread. Does not deliver to listeners registered
+         * through the legacy EventCenter.
+         */
+        class EventSender {
+            using CenterType = decltype(EventCenterType::get());
+
+            std::shared_ptr<BaseFilter> m_filter;
+            std::weak_ptr<OpaquePortBase> m_port;
+            CenterType m_center = nullptr;
+            // Generation of m_center at the last lookup, used to skip the
+            // lookup entirely while nothing new has been registered
+            size_t m_generation = 0;
+
+            friend class BasicEvent;
+
+            std::shared_ptr<OpaquePortBase> resolve(CenterType center) noexcept {
+                auto generation = center->getGeneration();
+                if (center == m_center && generation == m_generation) return nullptr;
+                m_center = center;
+                m_generation = generation;
+
+                auto port = center->resolvePort(m_filter.get(), &BasicEvent::migratePort, LatestPortVersion);
+                m_port = port;
+                return port;
+            }
+
+        public:
+            EventSender() noexcept = default;
+
+            bool send(PArgs... args) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>) {
+                if (!m_filter) return false;
+                GEODE_EVENT_PROFILE_SEND(Marker);
+                watchdog::Scope watchdogScope(nullptr, typeid(Marker).name(), true);
+
+                auto center = EventCenterType::get();
+                std::shared_ptr<OpaquePortBase> port;
+                if (center == m_center) {
+                    port = m_port.lock();
+                }
+                if (!port) {
+                    port = this->resolve(center);
+                    if (!port) return false;
+                }
+                return static_cast<LatestOpaqueEventType*>(port.get())->send(args...);
+            }
+
+            /**
+             * Whether the sender is currently bound to a port, i.e. whether
+             * there is anyone listening to this event
+             */
+            bool isBound() const noexcept {
+                return !m_port.expired();
+            }
+        };
+
+    protected:
+        static EventSender senderOf(BaseFilter const* filter) noexcept {
+            EventSender ret;
+            ret.m_filter = std::shared_ptr<BaseFilter>(filter->clone());
+            if (ret.m_filter) {
+                ret.resolve(EventCenterType::get());
+            }
+            return ret;
+        }
+
+    public:
+        /**
+         * Resolve this filter into a reusable sender
+         */
+        EventSender sender() const noexcept {
+            return BasicEvent::senderOf(this);
+        }
+
+        /**
+         * A non-owning filter that compares and hashes equal to the event with
+         * the same filter values, but holds strings as std::string_view. Sending
+         * through a view skips constructing (and allocating) the filter values,
+         * they are only copied if a listener has to be registered with them.
+         * A view must not outlive the values it was created from.
+         * @example Dispatch<int>::view("my-mod/my-event").send(5);
+         */
+        class View final : public BaseFilter {
+            std::tuple<FilterViewType<FArgs>...> m_filter;
+
+            friend class BasicEvent;
+
+            View(FilterViewType<FArgs>... value) noexcept : m_filter(value...) {}
+
+        public:
+            bool operator==(BaseFilter const& other) const noexcept override {
+                if (auto o = geode::cast::typeinfo_cast<Self const*>(&other)) {
+                    return m_filter == o->m_filter;
+                }
+                if (auto o = geode::cast::typeinfo_cast<View const*>(&other)) {
+                    return m_filter == o->m_filter;
+                }
+                return false;
+            }
+
+            size_t hash() const noexcept override {
+                auto seed = typenameHash<Marker>();
+                std::apply([&seed](auto const&... elems) {
+                    (hashCombine(seed, elems), ...);
+                }, m_filter);
+                return seed;
+            }
+
+            // Ports are keyed by clones, so this is where the values get interned
+            BaseFilter* clone() const noexcept override {
+                return std::apply([](auto const&... elems) -> BaseFilter* {
+                    return new (std::nothrow) Self(CloneMarker{}, std::tuple<FArgs...>(FArgs(elems)...));
+                }, m_filter);
+            }
+
+            OpaquePortBase* getPort() const noexcept override {
+                return new (std::nothrow) OpaqueEventV2Type();
+            }
+
+            bool send(PArgs... args) const noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>) {
+                return BasicEvent::sendTo(this, std::forward<PArgs>(args)...);
+            }
+
+            size_t getReceiverCount() const noexcept {
+                return BasicEvent::getReceiverCountOf(this);
+            }
+
+            EventSender sender() const noexcept {
+                return BasicEvent::senderOf(this);
+            }
+        };
+
+        static View view(FilterViewType<FArgs>... value) noexcept {
+            return View(value...);
+        }
+
         template<class Callable>
         ListenerHandle listen(Callable listener, int priority = 0) const noexcept {
             if constexpr (std::is_convertible_v<std::invoke_result_t<Callable, PArgs...>, bool>) {
@@ -663,6 +1029,15 @@ namespace geode::comm {
         }
     };
 
+    // Event center for non thread-safe events. geode::Event goes through the
+    // single center returned by get(), which doesn't lock, so such events
+    // should only be used from one thread at a time (usually the main thread).
+    // geode::ThreadLocalEvent goes through getForCurrentThread() instead: every
+    // thread has its own center, and a listener only receives events sent
+    // from the thread it was registered on. Its listener handles may be
+    // destroyed from any thread. If it isn't the thread that registered the
+    // listener, the removal is handed off to that thread and applied the next
+    // time it touches its event center.
     class GEODE_DLL EventCenterThreadLocal {
     private:
         class Impl;
@@ -673,6 +1048,7 @@ namespace geode::comm {
 
     public:
         static EventCenterThreadLocal* get();
+        static EventCenterThreadLocal* getForCurrentThread();
 
         using SendFuncType = geode::Function<bool(OpaquePortBase*)>;
         using AddFuncType = geode::Function<ReceiverHandle(OpaquePortBase*)>;
@@ -684,8 +1060,29 @@ namespace geode::comm {
         ListenerHandle addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort) noexcept;
         size_t getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort) noexcept;
         size_t removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort) noexcept;
+
+        // These only call migratePort if the stored port has not been checked
+        // against the given version yet
+        bool send(BaseFilter const* filter, SendFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept;
+        ListenerHandle addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept;
+        size_t getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept;
+        size_t removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept;
+
+        // Finds the port for a filter without sending anything, for EventSender
+        std::shared_ptr<OpaquePortBase> resolvePort(BaseFilter const* filter, MigrateFuncType migratePort, PortVersion version) noexcept;
+        // Changes every time a port is added or replaced
+        size_t getGeneration() const noexcept;
     };
 
+    struct EventCenterPerThread {
+        static EventCenterThreadLocal* get() {
+            return EventCenterThreadLocal::getForCurrentThread();
+        }
+    };
+
+    // Event center for thread-safe events. Ports are spread over several
+    // independently locked shards by filter hash, so threads sending
+    // unrelated events don't contend on the same lock.
     class GEODE_DLL EventCenterGlobal {
     private:
         class Impl;
@@ -707,6 +1104,18 @@ namespace geode::comm {
         ListenerHandle addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort) noexcept;
         size_t getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort) noexcept;
         size_t removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort) noexcept;
+
+        // These only call migratePort if the stored port has not been checked
+        // against the given version yet
+        bool send(BaseFilter const* filter, SendFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept;
+        ListenerHandle addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept;
+        size_t getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept;
+        size_t removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept;
+
+        // Finds the port for a filter without sending anything, for EventSender
+        std::shared_ptr<OpaquePortBase> resolvePort(BaseFilter const* filter, MigrateFuncType migratePort, PortVersion version) noexcept;
+        // Changes every time a port is added or replaced
+        size_t getGeneration() const noexcept;
     };
 
     class EventCenter {
@@ -818,15 +1227,26 @@ namespace geode::comm {
         std::is_convertible_v<PReturn, bool> || std::is_same_v<PReturn, void>;
     }
     bool BasicEvent<Marker, PortTemplate, PReturn(PArgs...), FArgs...>::send(PArgs... args) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>) {
-        auto ret = EventCenterType::get()->send(this, [&](OpaquePortBase* opaquePort) {
+        return BasicEvent::sendTo(this, std::forward<PArgs>(args)...);
+    }
+
+    template <class Marker, template <class> class PortTemplate, class PReturn, class... PArgs, class... FArgs>
+    requires requires {
+        typename OpaqueEventPort<PortTemplate, PArgs...>;
+        std::is_convertible_v<PReturn, bool> || std::is_same_v<PReturn, void>;
+    }
+    bool BasicEvent<Marker, PortTemplate, PReturn(PArgs...), FArgs...>::sendTo(BaseFilter const* filter, PArgs... args) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>) {
+        GEODE_EVENT_PROFILE_SEND(Marker);
+        watchdog::Scope watchdogScope(nullptr, typeid(Marker).name(), true);
+        auto ret = EventCenterType::get()->send(filter, [&](OpaquePortBase* opaquePort) {
             auto port = static_cast<LatestOpaqueEventType*>(opaquePort);
             return port->send(args...);
-        }, &BasicEvent::migratePort);
+        }, &BasicEvent::migratePort, LatestPortVersion);
 
         if (ret) return true;
 
         // fallback on the old event center
-        return EventCenter::get()->send(this, [&](OpaquePortBase* opaquePort) {
+        return EventCenter::get()->send(filter, [&](OpaquePortBase* opaquePort) {
             auto port = static_cast<OpaqueEventType*>(opaquePort);
             return port->send(std::forward<PArgs>(args)...);
         }, &BasicEvent::migratePort);
@@ -841,7 +1261,53 @@ namespace geode::comm {
         return EventCenterType::get()->addReceiver(this, [&](OpaquePortBase* opaquePort) {
             auto port = static_cast<LatestOpaqueEventType*>(opaquePort);
             return port->addReceiver(std::move(rec), priority);
+        }, &BasicEvent::migratePort, LatestPortVersion);
+    }
+
+    template <class Marker, template <class> class PortTemplate, class PReturn, class... PArgs, class... FArgs>
+    requires requires {
+        typename OpaqueEventPort<PortTemplate, PArgs...>;
+        std::is_convertible_v<PReturn, bool> || std::is_same_v<PReturn, void>;
+    }
+    size_t BasicEvent<Marker, PortTemplate, PReturn(PArgs...), FArgs...>::sendBatch(std::span<Payload> payloads) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>) {
+        if (payloads.empty()) return 0;
+        GEODE_EVENT_PROFILE_SEND(Marker);
+        watchdog::Scope watchdogScope(nullptr, typeid(Marker).name(), true);
+
+        auto stoppedBatch = std::apply([&](auto const&... fargs) {
+            return BatchEventType::view(fargs...).send(payloads);
+        }, m_filter);
+        if (stoppedBatch) return payloads.size();
+
+        // only allocated if some payload gets stopped, for the legacy center to skip it
+        std::vector<bool> stopped;
+        size_t count = 0;
+        EventCenterType::get()->send(this, [&](OpaquePortBase* opaquePort) {
+            auto port = static_cast<LatestOpaqueEventType*>(opaquePort);
+            port->sendBatch(payloads, [&](size_t index) {
+                if (stopped.empty()) stopped.resize(payloads.size());
+                stopped[index] = true;
+                count += 1;
+            });
+            return true;
+        }, &BasicEvent::migratePort, LatestPortVersion);
+
+        if (count == payloads.size()) return count;
+
+        // fallback on the old event center
+        EventCenter::get()->send(this, [&](OpaquePortBase* opaquePort) {
+            auto port = static_cast<OpaqueEventType*>(opaquePort);
+            for (size_t i = 0; i < payloads.size(); ++i) {
+                if (!stopped.empty() && stopped[i]) continue;
+                auto stop = std::apply([&](auto&... args) {
+                    return port->send(args...);
+                }, payloads[i]);
+                if (stop) count += 1;
+            }
+            return true;
         }, &BasicEvent::migratePort);
+
+        return count;
     }
 
     template <class Marker, template <class> class PortTemplate, class PReturn, class... PArgs, class... FArgs>
@@ -850,10 +1316,19 @@ namespace geode::comm {
         std::is_convertible_v<PReturn, bool> || std::is_same_v<PReturn, void>;
     }
     size_t BasicEvent<Marker, PortTemplate, PReturn(PArgs...), FArgs...>::getReceiverCount() const noexcept {
-        return EventCenterType::get()->getReceiverCount(this, [&](OpaquePortBase* opaquePort) {
+        return BasicEvent::getReceiverCountOf(this);
+    }
+
+    template <class Marker, template <class> class PortTemplate, class PReturn, class... PArgs, class... FArgs>
+    requires requires {
+        typename OpaqueEventPort<PortTemplate, PArgs...>;
+        std::is_convertible_v<PReturn, bool> || std::is_same_v<PReturn, void>;
+    }
+    size_t BasicEvent<Marker, PortTemplate, PReturn(PArgs...), FArgs...>::getReceiverCountOf(BaseFilter const* filter) noexcept {
+        return EventCenterType::get()->getReceiverCount(filter, [&](OpaquePortBase* opaquePort) {
             auto port = static_cast<LatestOpaqueEventType*>(opaquePort);
             return port->getReceiverCount();
-        }, &BasicEvent::migratePort);
+        }, &BasicEvent::migratePort, LatestPortVersion);
     }
 
     template <class Marker, template <class> class PortTemplate, class PReturn, class... PArgs, class... FArgs>
@@ -862,10 +1337,11 @@ namespace geode::comm {
         std::is_convertible_v<PReturn, bool> || std::is_same_v<PReturn, void>;
     }
     size_t BasicEvent<Marker, PortTemplate, PReturn(PArgs...), FArgs...>::removeReceiver(ReceiverHandle handle) const noexcept {
-        return EventCenterType::get()->removeReceiver(this, [&](OpaquePortBase* opaquePort) {
+        // captured by value, the removal may be deferred to another thread
+        return EventCenterType::get()->removeReceiver(this, [handle](OpaquePortBase* opaquePort) {
             auto port = static_cast<LatestOpaqueEventType*>(opaquePort);
             return port->removeReceiver(handle);
-        }, &BasicEvent::migratePort);
+        }, &BasicEvent::migratePort, LatestPortVersion);
     }
 }
 
@@ -882,6 +1358,12 @@ namespace geode {
         using comm::BasicEvent<Marker, comm::PortWrapper<comm::Port, true, comm::PortCallableCopy>::type, PFunc, FArgs...>::BasicEvent;
     };
 
+    // Like Event, but every thread has its own listeners for it
+    template<class Marker, class PFunc, class... FArgs>
+    struct ThreadLocalEvent : public comm::BasicEvent<Marker, comm::PortWrapper<comm::ThreadLocalPort, false, comm::PortCallableCopy>::type, PFunc, FArgs...> {
+        using comm::BasicEvent<Marker, comm::PortWrapper<comm::ThreadLocalPort, false, comm::PortCallableCopy>::type, PFunc, FArgs...>::BasicEvent;
+    };
+
 namespace comm {
     template<class Marker, bool ThreadSafe, class GFunc, class PFunc, class... FArgs>
     struct BasicGlobalEvent {};
@@ -958,12 +1440,72 @@ namespace comm {
             }
         }
 
+        class EventSender {
+            typename Event1Type::EventSender m_specific;
+            typename Event2Type::EventSender m_global;
+            std::optional<std::tuple<FArgs...>> m_filter;
+
+            friend struct BasicGlobalEvent;
+
+        public:
+            EventSender() noexcept = default;
+
+            bool send(PArgs... args) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>) {
+                if (!m_filter.has_value()) return false;
+                if (m_specific.send(args...)) return true;
+
+                return std::apply([&](auto const&... fargs) {
+                    return m_global.send(fargs..., std::forward<PArgs>(args)...);
+                }, *m_filter);
+            }
+        };
+
+        /**
+         * Resolve this event into a reusable sender, see BasicEvent::sender
+         */
+        EventSender sender() const noexcept {
+            EventSender ret;
+            if (m_filter.has_value()) {
+                ret.m_specific = std::apply([&](auto const&... fargs) {
+                    return Event1Type(fargs...).sender();
+                }, *m_filter);
+                ret.m_global = Event2Type().sender();
+                ret.m_filter = m_filter;
+            }
+            return ret;
+        }
+
+        /**
+         * A non-owning view of this event, see BasicEvent::View. Listeners of
+         * every filter still get their own copy of the filter values
+         */
+        class View {
+            typename Event1Type::View m_specific;
+            std::tuple<FilterViewType<FArgs>...> m_filter;
+
+            friend struct BasicGlobalEvent;
+
+            View(FilterViewType<FArgs>... value) noexcept : m_specific(Event1Type::view(value...)), m_filter(value...) {}
+
+        public:
+            bool send(PArgs... args) const noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>) {
+                if (m_specific.send(args...)) return true;
+
+                return std::apply([&](auto const&... fargs) {
+                    return Event2Type().send(FArgs(fargs)..., std::forward<PArgs>(args)...);
+                }, m_filter);
+            }
+        };
+
+        static View view(FilterViewType<FArgs>... value) noexcept {
+            return View(value...);
+        }
+
         bool send(PArgs... args) noexcept(std::is_nothrow_invocable_v<geode::CopyableFunction<PReturn(PArgs...)>, PArgs...>) {
             if (m_filter.has_value()) {
-                auto filterCopy = *m_filter;
-                auto ret = std::apply([&](auto&&... fargs) {
-                    return Event1Type(std::move(fargs)...).send(args...);
-                }, std::move(filterCopy));
+                auto ret = std::apply([&](auto const&... fargs) {
+                    return Event1Type::view(fargs...).send(args...);
+                }, *m_filter);
                 if (ret) return true;
 
                 return std::apply([&](auto&&... fargs) {
@@ -0,0 +1,119 @@
+#pragma once
+
+// Opt-in instrumentation for the event system, enabled by configuring Geode
+// with -DGEODE_EVENT_PROFILER=ON. It doesn't change the layout of any port or
+// receiver, so mods built without it still work with a profiling loader, but
+// mods built with it need a loader that was too. When disabled, none of this
+// exists and the hooks in Event.hpp expand to nothing.
+
+#ifdef GEODE_EVENT_PROFILER
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <Geode/platform/platform.hpp>
+
+namespace geode {
+    class Mod;
+}
+
+namespace geode::comm::profiler {
+    /**
+     * Timings of one mod's receivers for one event type
+     */
+    struct ReceiverStats {
+        std::string eventType;
+        // The mod that registered the receivers, or nullptr if unknown
+        Mod* mod = nullptr;
+        size_t calls = 0;
+        std::chrono::nanoseconds totalTime{0};
+        std::chrono::nanoseconds maxTime{0};
+    };
+
+    /**
+     * Totals for one event type
+     */
+    struct EventStats {
+        std::string eventType;
+        size_t sends = 0;
+        size_t receiversInvoked = 0;
+        std::chrono::nanoseconds totalTime{0};
+    };
+
+    struct Snapshot {
+        std::vector<EventStats> events;
+        std::vector<ReceiverStats> receivers;
+    };
+
+    /**
+     * Pause or resume recording. Recording is on by default when the
+     * profiler is compiled in
+     */
+    GEODE_DLL void setEnabled(bool enabled) noexcept;
+    GEODE_DLL bool isEnabled() noexcept;
+
+    /**
+     * Get the stats recorded since startup or the last reset, sorted by
+     * total time spent, highest first
+     */
+    GEODE_DLL Snapshot snapshot();
+    GEODE_DLL void reset();
+
+    /**
+     * Serialize a snapshot into JSON
+     */
+    GEODE_DLL std::string exportJSON(Snapshot const& snapshot);
+
+    // Hooks used by Event.hpp, not meant to be called directly
+
+    GEODE_DLL void recordSend(char const* eventType) noexcept;
+    GEODE_DLL void recordReceiver(char const* eventType, Mod* mod, std::chrono::nanoseconds time) noexcept;
+
+    // The event type currently being sent on this thread
+    GEODE_DLL char const*& currentEvent() noexcept;
+
+    class SendScope {
+        char const* m_previous;
+    public:
+        explicit SendScope(char const* eventType, bool count = true) noexcept : m_previous(currentEvent()) {
+            currentEvent() = eventType;
+            if (count) recordSend(eventType);
+        }
+        ~SendScope() noexcept {
+            currentEvent() = m_previous;
+        }
+        SendScope(SendScope const&) = delete;
+        SendScope& operator=(SendScope const&) = delete;
+    };
+
+    class ReceiverScope {
+        Mod* m_mod;
+        std::chrono::steady_clock::time_point m_start;
+    public:
+        explicit ReceiverScope(Mod* mod) noexcept
+            : m_mod(mod), m_start(std::chrono::steady_clock::now()) {}
+        ~ReceiverScope() noexcept {
+            recordReceiver(currentEvent(), m_mod, std::chrono::steady_clock::now() - m_start);
+        }
+        ReceiverScope(ReceiverScope const&) = delete;
+        ReceiverScope& operator=(ReceiverScope const&) = delete;
+    };
+
+    template <class Marker>
+    char const* eventName() noexcept {
+        static char const* const s_name = typeid(Marker).name();
+        return s_name;
+    }
+}
+
+#define GEODE_EVENT_PROFILE_SEND(Marker) \
+    ::geode::comm::profiler::SendScope _geodeProfileSend(::geode::comm::profiler::eventName<Marker>())
+#define GEODE_EVENT_PROFILE_RECEIVER(port, receiver) \
+    ::geode::comm::profiler::ReceiverScope _geodeProfileReceiver(::geode::comm::getReceiverOwner(port, (receiver).m_handle))
+
+#else
+
+#define GEODE_EVENT_PROFILE_SEND(Marker)
+#define GEODE_EVENT_PROFILE_RECEIVER(port, receiver)
+
+#endif
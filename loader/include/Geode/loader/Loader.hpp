@@ -7,7 +7,9 @@
 #include "ModMetadata.hpp"
 #include "Types.hpp"
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <matjson.hpp>
 #include <mutex>
 #include <optional>
@@ -16,6 +18,39 @@
 namespace geode {
     using ScheduledFunction = geode::Function<void()>;
 
+    /**
+     * When a function queued with `queueInMainThread` gets to run. Functions
+     * of the same priority run in the order they were queued. Functions queued
+     * without a priority are High, so they all run on the next frame
+     */
+    enum class MainThreadPriority : uint8_t {
+        /// Runs on the next frame, before anything else, regardless of the frame budget
+        High = 0,
+        /// Runs within the frame budget, so a burst of functions may be spread
+        /// over several frames
+        Normal = 1,
+        /// Runs within the frame budget after Normal functions, for work that
+        /// can wait, like progress updates or texture uploads
+        Low = 2,
+    };
+
+    struct MainThreadQueueStats {
+        /// Functions currently waiting to run, indexed by priority
+        std::array<size_t, 3> pending = {};
+        /// Functions run during the last frame
+        size_t lastFrameRuns = 0;
+        /// Time spent running queued functions during the last frame
+        std::chrono::microseconds lastFrameTime{0};
+        /// Time from queueing a function to running it, averaged over recent functions
+        std::chrono::microseconds averageLatency{0};
+        /// Longest time from queueing a function to running it
+        std::chrono::microseconds maxLatency{0};
+        /// Functions dropped because a newer one with the same coalescing key was queued
+        size_t coalesced = 0;
+        /// Frames that ran out of budget and left functions for the next frame
+        size_t budgetExceededFrames = 0;
+    };
+
     struct LoadProblem {
         enum class Type : uint8_t {
             /// Some other fatal error (like binary loading failing)
@@ -125,6 +160,33 @@ namespace geode {
         }
 
         void queueInMainThread(ScheduledFunction&& func);
+        /**
+         * @param owner The mod queueing the function, used to attribute
+         * hitches in the watchdog
+         */
+        void queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority, Mod* owner = geode::getMod());
+        /**
+         * Queue a function to run on the main thread, replacing a function
+         * queued earlier with the same key that hasn't run yet. The function
+         * keeps the earlier one's place in the queue. Useful for updates where
+         * only the latest one matters, like progress notifications
+         * @param key Key identifying the update, should be prefixed with the mod ID
+         */
+        void queueInMainThreadCoalesced(
+            std::string key, ScheduledFunction&& func,
+            MainThreadPriority priority = MainThreadPriority::High,
+            Mod* owner = geode::getMod()
+        );
+        /**
+         * Set how much time per frame may be spent running Normal and Low
+         * priority functions. Time spent over the budget is taken off the
+         * next frame's budget. At least one function of each priority still
+         * runs every frame, so nothing waits forever.
+         * Can also be set with the `main-thread-budget` launch argument, in milliseconds
+         */
+        void setMainThreadBudget(std::chrono::microseconds budget);
+        std::chrono::microseconds getMainThreadBudget() const;
+        MainThreadQueueStats getMainThreadQueueStats() const;
 
         /**
          * Returns the current game version.
@@ -154,7 +216,18 @@ namespace geode {
      * @param func the function to queue
     */
     inline void queueInMainThread(ScheduledFunction&& func) {
-        Loader::get()->queueInMainThread(std::move(func));
+        // the priority is spelled out so that the owner is the calling mod
+        Loader::get()->queueInMainThread(std::move(func), MainThreadPriority::High);
+    }
+
+    /**
+     * @brief Queues a function to run on the main thread with the given priority
+     *
+     * @param func the function to queue
+     * @param priority when the function should run
+    */
+    inline void queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority) {
+        Loader::get()->queueInMainThread(std::move(func), priority);
     }
 
     /**
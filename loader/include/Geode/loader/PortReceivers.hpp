@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// How the non thread-safe comm::Port keeps its receivers. Only uses the
+// standard library, so that it can be tested on the host (see test/host)
+namespace geode::comm {
+    using ReceiverHandle = size_t;
+
+    // The receivers are a vector that mods built against older headers walk
+    // and modify directly, so it can't be swapped for a tree. Inserting and
+    // erasing still move every receiver after the position; only finding the
+    // position is logarithmic.
+    //
+    // Receivers are sorted by priority. Within the same priority, the ones
+    // added through these headers are in the order they were added, which is
+    // also the order of their handles, since handles only go up.
+    namespace receivers {
+        template <class Vector>
+        auto insertPosition(Vector& receivers, int priority) {
+            return std::upper_bound(receivers.begin(), receivers.end(), priority, [](int priority, auto const& r) {
+                return priority < r.m_priority;
+            });
+        }
+
+        // Binary searches every priority for the handle, which is
+        // O(priorities * log n). Older mods sort pending receivers in with an
+        // unstable sort, so if that misses, it falls back to a linear search
+        template <class Vector>
+        auto find(Vector& receivers, ReceiverHandle handle) {
+            auto first = receivers.begin();
+            auto last = receivers.end();
+            while (first != last) {
+                auto priority = first->m_priority;
+                auto band = std::upper_bound(first, last, priority, [](int priority, auto const& r) {
+                    return priority < r.m_priority;
+                });
+                auto it = std::lower_bound(first, band, handle, [](auto const& r, ReceiverHandle handle) {
+                    return r.m_handle < handle;
+                });
+                if (it != band && it->m_handle == handle) {
+                    return it;
+                }
+                first = band;
+            }
+            return std::find_if(receivers.begin(), last, [&](auto const& r) {
+                return r.m_handle == handle;
+            });
+        }
+
+        // Receivers removed during a send, which are skipped until the send
+        // finishes. Older mods append to the list without sorting it, so it
+        // is sorted again whenever it has grown since the last lookup
+        template <class Iterator>
+        class PendingRemovals {
+            std::vector<Iterator>& m_toRemove;
+            size_t m_sorted = 0;
+
+        public:
+            explicit PendingRemovals(std::vector<Iterator>& toRemove) : m_toRemove(toRemove) {}
+
+            bool contains(Iterator it) {
+                if (m_toRemove.empty()) return false;
+                if (m_toRemove.size() != m_sorted) {
+                    std::sort(m_toRemove.begin(), m_toRemove.end());
+                    m_sorted = m_toRemove.size();
+                }
+                return std::binary_search(m_toRemove.begin(), m_toRemove.end(), it);
+            }
+        };
+
+        // Erases the pending removals in one pass, keeping the order
+        template <class Vector, class Iterator>
+        void erase(Vector& receivers, std::vector<Iterator>& toRemove) {
+            if (toRemove.empty()) return;
+            std::sort(toRemove.begin(), toRemove.end());
+            auto next = toRemove.begin();
+            auto out = receivers.begin();
+            for (auto it = receivers.begin(); it != receivers.end(); ++it) {
+                if (next != toRemove.end() && *next == it) {
+                    // the same receiver may have been removed more than once
+                    while (next != toRemove.end() && *next == it) ++next;
+                    continue;
+                }
+                if (out != it) {
+                    *out = std::move(*it);
+                }
+                ++out;
+            }
+            receivers.erase(out, receivers.end());
+            toRemove.clear();
+        }
+    }
+}
@@ -3,13 +3,24 @@
 #include "Event.hpp"
 #include "../platform/platform.hpp"
 #include "Log.hpp"
+#include "../utils/terminate.hpp"
 
 namespace geode::comm {
 	class ObserverContext;
+	struct SignalInternal;
+
+	// Forgets the rank of a destroyed signal. Ranks are kept by the loader
+	// for the batch open on the calling thread, since signals made by mods
+	// built against older headers have no room for them
+	GEODE_DLL void forgetSignalRank(SignalInternal const* sig) noexcept;
 
 	struct SignalInternal {
 		virtual void removePortReceiver(ReceiverHandle handle) noexcept = 0;
 		virtual ReceiverHandle addPortReceiver(ObserverContext handle) noexcept = 0;
+
+		~SignalInternal() noexcept {
+			forgetSignalRank(this);
+		}
 	};
 
 	class ObserverContext {
@@ -17,10 +28,22 @@ namespace geode::comm {
 		friend class Signal;
 		template <bool ThreadSafe>
 		friend class BasicObserver;
+		template <class Type>
+		friend class Computed;
+		friend class SignalBatch;
 
 		struct Impl {
 			geode::Function<void()> effect;
 			mutable std::vector<std::pair<std::weak_ptr<SignalInternal>, ReceiverHandle>> registered;
+			// Highest rank of the signals this observer reads
+			std::atomic_size_t rank = 0;
+			// Whether this observer is waiting for the current batch to commit
+			std::atomic_bool queued = false;
+			// Runs right away even inside a batch. Used by Computed to mark
+			// itself out of date before anything in the batch reads it
+			bool immediate = false;
+
+			Impl(geode::Function<void()> effect) noexcept : effect(std::move(effect)) {}
 
 			void clearSignals() const noexcept;
 			~Impl() noexcept;
@@ -30,11 +53,46 @@ namespace geode::comm {
 		static thread_local std::vector<ObserverContext> stack;
 		static ObserverContext* top() noexcept;
 		void registerSignal(std::shared_ptr<SignalInternal> sig) noexcept;
+		// Runs the effect right away, even inside a batch
+		void run() const noexcept;
+		// Called when a signal this observer reads is set
+		static void signalChanged(SignalInternal& sig) noexcept;
 
 		// sooo std23::move_only_function is broken in single-arg ctors with operator()
 		ObserverContext(geode::Function<void()> effect, std::monostate) noexcept;
 	public:
 		void operator()() const noexcept;
+
+		// Ports check their receivers for emptiness before calling them
+		explicit operator bool() const noexcept {
+			return impl != nullptr;
+		}
+	};
+
+	/**
+	 * Defers observer notifications on this thread until the outermost batch
+	 * ends. Every observer affected by the signals set during the batch then
+	 * runs once, after the observers that set signals it depends on, so it
+	 * never sees a half-applied update.
+	 * @example
+	 * {
+	 *     SignalBatch batch;
+	 *     width = 100;
+	 *     height = 200;
+	 * } // observers of width and height run once here
+	 */
+	class GEODE_DLL SignalBatch {
+	public:
+		SignalBatch() noexcept;
+		~SignalBatch() noexcept;
+
+		SignalBatch(SignalBatch const&) = delete;
+		SignalBatch& operator=(SignalBatch const&) = delete;
+
+		/**
+		 * Whether a batch is open on the current thread
+		 */
+		static bool active() noexcept;
 	};
 
 	template <bool ThreadSafe = false>
@@ -56,10 +114,11 @@ namespace geode::comm {
 			if constexpr (ThreadSafe)
 				mutex.lock();
 			contexts.push_back(ObserverContext(std::move(func), {}));
-			auto& back = contexts.back();
+			auto back = contexts.back();
 			if constexpr (ThreadSafe)
 				mutex.unlock();
-			std::invoke(contexts.back());
+			// the first run registers the dependencies, so it can't wait for a batch
+			back.run();
 		}
 
 		~BasicObserver() {
@@ -111,6 +170,7 @@ namespace geode::comm {
 		        if (!impl->inCtx.test_and_set()) {
 		            std::lock_guard lk(impl->mutex);
 		            impl->value = std::move(val);
+		            ObserverContext::signalChanged(*impl);
 		            impl->port.send();
 		            impl->inCtx.clear();
 		        } else {
@@ -120,6 +180,7 @@ namespace geode::comm {
 		        if (!impl->inCtx) {
 		            impl->inCtx = true;
 		            impl->value = std::move(val);
+		            ObserverContext::signalChanged(*impl);
 		            impl->port.send();
 		            impl->inCtx = false;
 		        } else {
@@ -164,4 +225,107 @@ namespace geode::comm {
 
 	template <class Type>
 	using ThreadSafeSignal = Signal<Type, true>;
+
+	/**
+	 * A value derived from other signals. The value is cached, and only
+	 * recomputed when it is read after a signal it read last time changed.
+	 * Observers, and other computed values, can depend on it like on a
+	 * signal, and get notified whenever its dependencies change.
+	 * Not thread safe, a computed value should only be used on one thread.
+	 * @example
+	 * Computed<std::string> label = [=] mutable { return fmt::format("{} mods", count.get()); };
+	 */
+	template <class Type>
+	class Computed {
+		struct Impl : SignalInternal {
+			Port<ObserverContext, false> port;
+			geode::Function<Type()> compute;
+			std::optional<Type> value;
+			// Reads done while computing register the dependencies on this
+			ObserverContext tracker;
+			bool dirty = true;
+			bool computing = false;
+
+			Impl(geode::Function<Type()> compute) noexcept
+				: compute(std::move(compute)), tracker(geode::Function<void()>(), {}) {}
+			~Impl() noexcept {
+				tracker.impl->clearSignals();
+			}
+
+			void removePortReceiver(ReceiverHandle handle) noexcept override {
+				port.removeReceiver(handle);
+			}
+			ReceiverHandle addPortReceiver(ObserverContext obs) noexcept override {
+				return port.addReceiver(obs);
+			}
+		};
+
+		std::shared_ptr<Impl> impl;
+	public:
+		template <class F>
+		requires std::is_invocable_r_v<Type, F&>
+		Computed(F&& compute) noexcept : impl(std::make_shared<Impl>(std::forward<F>(compute))) {
+			// a dependency changed, so drop the cached value and let the readers
+			// know, which recomputes it only if they read it again
+			impl->tracker = ObserverContext([weak = std::weak_ptr<Impl>(impl)] {
+				if (auto impl = weak.lock()) {
+					impl->dirty = true;
+					ObserverContext::signalChanged(*impl);
+					impl->port.send();
+				}
+			}, {});
+			// inside a batch only the readers' notifications wait for the commit
+			impl->tracker.impl->immediate = true;
+		}
+		Computed(Computed const& other) noexcept : impl(other.impl) {}
+
+		void operator=(Computed other) = delete;
+
+		Type const& get() {
+			if (impl->computing) {
+				// there is nothing to return before the first computation finishes
+				if (!impl->value) {
+					geode::utils::terminate("Computed value read within its own first computation");
+				}
+				geode::log::debug("Attempted to read computed value within its own computation");
+			} else if (impl->dirty) {
+				impl->computing = true;
+				impl->dirty = false;
+
+				impl->tracker.impl->clearSignals();
+				ObserverContext::stack.push_back(impl->tracker);
+
+				// if compute throws, the next read computes again
+				struct Guard {
+					Impl& impl;
+					bool done = false;
+					~Guard() noexcept {
+						ObserverContext::stack.pop_back();
+						impl.computing = false;
+						if (!done) impl.dirty = true;
+					}
+				} guard{*impl};
+				impl->value.emplace(std::invoke(impl->compute));
+				guard.done = true;
+			}
+
+			// a value can't depend on itself
+			auto observer = ObserverContext::top();
+			if (observer && observer->impl != impl->tracker.impl) {
+				observer->registerSignal(impl);
+			}
+
+			return *impl->value;
+		}
+
+		/**
+		 * Whether the cached value is out of date, i.e. the next read recomputes it
+		 */
+		bool isDirty() const noexcept {
+			return impl->dirty;
+		}
+
+		Type const& operator*() { return get(); }
+		Type const* operator->() { return &get(); }
+	};
 };
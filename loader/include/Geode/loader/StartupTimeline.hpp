@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <Geode/platform/platform.hpp>
+
+// Timeline of the loader's startup pipeline. Every phase of loading is
+// recorded per mod, from finding the packages to adding their resources,
+// and once startup is done the timeline is frozen and written to
+// `getGeodeLogDir()`/startup-trace.json in the Chrome trace format (open
+// it in chrome://tracing or Perfetto).
+//
+// The spans are also readable at runtime, so a test mod can check the
+// timeline for regressions. When the zone profiler is enabled the spans
+// are forwarded to it as well.
+namespace geode::startup {
+    enum class Phase {
+        // Searching the mod directories, contains ParseMetadata
+        QueueMods,
+        // Reading mod.json and friends out of a package
+        ParseMetadata,
+        // Resolving the dependencies and incompatibilities of a mod
+        BuildModGraph,
+        // Extracting a package into the runtime directory
+        Unzip,
+        // Loading the binary of a mod, contains LoadedHandlers
+        LoadBinary,
+        // Enabling hooks created before the loader was ready to hook
+        LoadHooks,
+        // Running the $on_mod(Loaded) handlers of a mod
+        LoadedHandlers,
+        // Adding the search paths and spritesheets of a mod
+        UpdateResources,
+    };
+
+    GEODE_DLL std::string_view phaseName(Phase phase) noexcept;
+
+    struct Span {
+        Phase phase;
+        // ID of the mod, or the file name of its package while it's being
+        // parsed. Empty for spans that aren't about one mod
+        std::string mod;
+        std::string thread;
+        // Since the profiler epoch, see utils::profiler::now
+        std::chrono::nanoseconds start{0};
+        std::chrono::nanoseconds duration{0};
+    };
+
+    /**
+     * Get the recorded spans, ordered by start time
+     */
+    GEODE_DLL std::vector<Span> getTimeline();
+
+    /**
+     * Get the total time spent in a phase, optionally only for one mod.
+     * Spans of the same phase on different threads are summed up, so this
+     * can be more than wall time
+     */
+    GEODE_DLL std::chrono::nanoseconds getPhaseTime(Phase phase, std::string_view mod = {});
+
+    /**
+     * Whether startup has finished, which is once the mods are loaded and
+     * their resources have been added. No more spans are recorded after
+     * this point
+     */
+    GEODE_DLL bool isComplete() noexcept;
+
+    /**
+     * Time from the first recorded span to the end of startup, or so far
+     * if it hasn't finished yet
+     */
+    GEODE_DLL std::chrono::nanoseconds getTotalTime();
+
+    /**
+     * Where the trace is written once startup finishes
+     */
+    GEODE_DLL std::filesystem::path getTracePath();
+}
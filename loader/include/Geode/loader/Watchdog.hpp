@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <Geode/platform/platform.hpp>
+
+namespace geode {
+    class Mod;
+}
+
+// Opt-in main thread hitch watchdog. Work on the main thread is measured in
+// attributed scopes, and whenever a frame takes longer than the threshold,
+// the scopes that ran during it are recorded in a report, naming the mods
+// that spent the most time. Enabled with the `hitch-watchdog` launch flag,
+// or through setEnabled.
+//
+// Covered right now are functions queued with queueInMainThread, callbacks
+// of geode::async tasks, and event receivers, which are attributed to the
+// mod that added them and labeled with the event being sent.
+namespace geode::watchdog {
+    struct HitchEntry {
+        // The mod the work is attributed to, or nullptr if unknown
+        Mod* mod = nullptr;
+        std::string label;
+        // Time spent in this work during the frame, not counting nested scopes
+        std::chrono::microseconds time{0};
+        size_t calls = 0;
+    };
+
+    struct HitchReport {
+        // Frames since the watchdog was enabled
+        size_t frame = 0;
+        std::chrono::system_clock::time_point when;
+        std::chrono::microseconds frameTime{0};
+        // Time covered by scopes, the rest went to rendering, cocos
+        // schedules and other untracked work
+        std::chrono::microseconds attributedTime{0};
+        // The most expensive scopes of the frame, highest first
+        std::vector<HitchEntry> entries;
+    };
+
+    namespace detail {
+        // Exported so that isEnabled can be inlined into every scope and
+        // event send, which then don't call into the loader while disabled
+        GEODE_DLL extern std::atomic_bool enabled;
+        GEODE_DLL bool isMainThread() noexcept;
+    }
+
+    GEODE_DLL void setEnabled(bool enabled);
+    inline bool isEnabled() noexcept {
+        return detail::enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Whether scopes opened on this thread are recorded, which is when the
+     * watchdog is enabled and this is the main thread. Lets hot loops skip
+     * looking up what to attribute their work to
+     */
+    inline bool isActive() noexcept {
+        return isEnabled() && detail::isMainThread();
+    }
+
+    /**
+     * Frames taking longer than this are reported. Defaults to 50ms,
+     * can also be set with the `hitch-threshold` launch argument
+     */
+    GEODE_DLL void setThreshold(std::chrono::milliseconds threshold);
+    GEODE_DLL std::chrono::milliseconds getThreshold() noexcept;
+
+    /**
+     * Get the most recent hitch reports, oldest first. Only the last 32
+     * are kept
+     */
+    GEODE_DLL std::vector<HitchReport> getReports();
+    GEODE_DLL void clearReports();
+
+    /**
+     * Mark the start and end of attributed work on the main thread. Calls
+     * from other threads are ignored. Prefer using Scope
+     * @param label Must outlive the frame, like a string literal. If null,
+     * the label of the enclosing scope is used
+     * @param isTypeName Whether the label is a type name from typeid, which
+     * is demangled for the report
+     */
+    GEODE_DLL void beginScope(Mod* mod, char const* label, bool isTypeName = false) noexcept;
+    GEODE_DLL void endScope() noexcept;
+
+    class Scope {
+        bool m_active;
+    public:
+        Scope(Mod* mod, char const* label, bool isTypeName = false) noexcept
+            : Scope(isEnabled(), mod, label, isTypeName) {}
+        // For loops that already checked isActive or isEnabled once
+        Scope(bool active, Mod* mod, char const* label, bool isTypeName = false) noexcept : m_active(active) {
+            if (m_active) beginScope(mod, label, isTypeName);
+        }
+        ~Scope() noexcept {
+            if (m_active) endScope();
+        }
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+    };
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <Geode/platform/platform.hpp>
+
+namespace geode::utils {
+
+struct FramePoolStats {
+    /// Every allocation made through the pool
+    size_t allocations = 0;
+    /// Allocations served from a recycled block
+    size_t reused = 0;
+    /// Allocations too big for any size class, which go straight to the heap
+    size_t oversized = 0;
+    /// Blocks currently handed out
+    size_t live = 0;
+};
+
+/**
+ * Size-class pool for short-lived, similarly sized allocations like
+ * coroutine frames and async callback state. Blocks are rounded up to a
+ * power of two between 64 bytes and 4 KiB and recycled through thread
+ * local free lists, so steady async traffic stops hitting the heap once
+ * it's warmed up. Blocks may be freed on a different thread than the one
+ * that allocated them
+ */
+namespace frame_pool {
+    GEODE_DLL void* allocate(size_t size);
+    GEODE_DLL void deallocate(void* ptr, size_t size) noexcept;
+    GEODE_DLL FramePoolStats stats() noexcept;
+}
+
+/**
+ * Standard allocator backed by the frame pool, for `std::allocate_shared`
+ * and friends
+ */
+template <class T>
+struct FramePoolAllocator {
+    using value_type = T;
+
+    FramePoolAllocator() noexcept = default;
+    template <class U>
+    FramePoolAllocator(FramePoolAllocator<U> const&) noexcept {}
+
+    T* allocate(size_t n) {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Over-aligned types aren't supported by the frame pool");
+        return static_cast<T*>(frame_pool::allocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) noexcept {
+        frame_pool::deallocate(ptr, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(FramePoolAllocator<U> const&) const noexcept { return true; }
+};
+
+/**
+ * Like `std::make_shared`, but the object and its reference counts are
+ * allocated from the frame pool. Over-aligned types fall back to
+ * `std::make_shared`
+ */
+template <class T, class... Args>
+std::shared_ptr<T> makePooledShared(Args&&... args) {
+    if constexpr (alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::allocate_shared<T>(FramePoolAllocator<T>(), std::forward<Args>(args)...);
+    }
+    else {
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+}
+
+/**
+ * Inherit from this in a coroutine promise type to allocate its frames
+ * from the frame pool
+ */
+struct PooledFrame {
+    static void* operator new(size_t size) {
+        return frame_pool::allocate(size);
+    }
+    static void operator delete(void* ptr, size_t size) noexcept {
+        frame_pool::deallocate(ptr, size);
+    }
+};
+
+}
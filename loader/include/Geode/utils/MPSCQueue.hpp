@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace geode::utils {
+
+/**
+ * Lock-free multi-producer queue. Any thread can push in O(1) without
+ * taking a lock, and the consumer takes everything pushed so far in one
+ * atomic exchange, then handles it in push order.
+ *
+ * Items pushed while a drain is running are left for the next drain, so
+ * a callback that pushes back into the queue can't make a drain loop
+ * forever.
+ *
+ * With `Pooled` set, drained nodes are recycled instead of freed, so a
+ * queue that sees steady traffic stops allocating once it's warmed up.
+ * The pool is shared by every pooled queue of the same `T`, and nodes
+ * go back to it in one atomic operation per drain. Producers take the
+ * whole pool at once into a thread local cache, which avoids the ABA
+ * problem of popping single nodes off a shared stack.
+ */
+template <class T, bool Pooled = false>
+class MPSCQueue {
+    struct Node {
+        union {
+            T value;
+        };
+        Node* next = nullptr;
+
+        Node() noexcept {}
+        ~Node() noexcept {}
+    };
+
+    struct ThreadCache {
+        Node* head = nullptr;
+
+        ~ThreadCache() noexcept {
+            while (head) {
+                auto next = head->next;
+                delete head;
+                head = next;
+            }
+        }
+    };
+
+    std::atomic<Node*> m_head = nullptr;
+
+    // Nodes given back by consumers, waiting to be taken by a producer.
+    // Never freed, since thread caches may still refill from it on exit
+    static inline std::atomic<Node*> s_pool = nullptr;
+
+    static Node* allocNode() {
+        if constexpr (Pooled) {
+            static thread_local ThreadCache s_cache;
+            if (!s_cache.head) {
+                s_cache.head = s_pool.exchange(nullptr, std::memory_order_acquire);
+            }
+            if (auto node = s_cache.head) {
+                s_cache.head = node->next;
+                return node;
+            }
+        }
+        return new Node();
+    }
+
+    // Gives back a chain of nodes whose values have already been destroyed
+    static void releaseChain(Node* first, Node* last) noexcept {
+        if (!first) return;
+        if constexpr (Pooled) {
+            last->next = s_pool.load(std::memory_order_relaxed);
+            while (!s_pool.compare_exchange_weak(
+                last->next, first, std::memory_order_release, std::memory_order_relaxed
+            )) {}
+        }
+        else {
+            while (first) {
+                auto next = first->next;
+                delete first;
+                first = next;
+            }
+        }
+    }
+
+    static void freeChain(Node* node) noexcept {
+        auto first = node;
+        Node* last = nullptr;
+        while (node) {
+            node->value.~T();
+            last = node;
+            node = node->next;
+        }
+        releaseChain(first, last);
+    }
+
+    // Reverses the stack into push order
+    static Node* reverse(Node* node) noexcept {
+        Node* prev = nullptr;
+        while (node) {
+            auto next = node->next;
+            node->next = prev;
+            prev = node;
+            node = next;
+        }
+        return prev;
+    }
+
+public:
+    MPSCQueue() noexcept = default;
+    MPSCQueue(MPSCQueue const&) = delete;
+    MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+    ~MPSCQueue() noexcept {
+        freeChain(m_head.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    /**
+     * Push a value into the queue. Safe to call from any thread
+     */
+    template <class... Args>
+    void push(Args&&... args) {
+        auto node = allocNode();
+        try {
+            new (&node->value) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            node->next = nullptr;
+            releaseChain(node, node);
+            throw;
+        }
+        node->next = m_head.load(std::memory_order_relaxed);
+        while (!m_head.compare_exchange_weak(
+            node->next, node, std::memory_order_release, std::memory_order_relaxed
+        )) {}
+    }
+
+    /**
+     * Take every value pushed so far and call `func` on each of them,
+     * in the order they were pushed. If `func` throws, the values left in
+     * this drain are dropped
+     * @returns The number of values drained
+     */
+    template <class F>
+    size_t drain(F&& func) {
+        auto node = reverse(m_head.exchange(nullptr, std::memory_order_acquire));
+        auto first = node;
+        Node* last = nullptr;
+        size_t count = 0;
+
+        // If func throws, the values it didn't get to are dropped, and the
+        // whole chain is still given back
+        struct Guard {
+            Node*& node;
+            Node*& last;
+            Node* first;
+
+            ~Guard() noexcept {
+                while (node) {
+                    node->value.~T();
+                    last = node;
+                    node = node->next;
+                }
+                releaseChain(first, last);
+            }
+        } guard { node, last, first };
+
+        while (node) {
+            func(node->value);
+            node->value.~T();
+            last = node;
+            node = node->next;
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * Whether the queue is currently empty. Only a snapshot, other
+     * threads may push right after this returns
+     */
+    bool empty() const noexcept {
+        return m_head.load(std::memory_order_relaxed) == nullptr;
+    }
+};
+
+}
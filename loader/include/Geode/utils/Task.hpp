@@ -4,9 +4,12 @@
 #include "function.hpp"
 #include "../loader/Event.hpp"
 #include "../loader/Loader.hpp"
+#include "FramePool.hpp"
 #include <mutex>
 #include <string_view>
 #include <coroutine>
+#include <utility>
+#include <vector>
 
 namespace geode {
     struct TaskVoid {};
@@ -116,6 +119,8 @@ namespace geode {
             Cancelled,
         };
 
+        class Event;
+
         /**
          * A handle to a running Task. This is what actually keeps track of
          * the state of the current task; the `Task` class is simply an owning
@@ -161,11 +166,24 @@ namespace geode {
             bool m_finalEventPosted = false;
             std::string m_name;
             std::unique_ptr<ExtraData> m_extraData = nullptr;
+        #ifdef GEODE_TASK_HANDLE_V2
+            // Functions receiving the events of this task on the main thread.
+            // Mods built without GEODE_TASK_HANDLE_V2 don't have this member,
+            // so it's only there in the handle of the next major version
+            std::vector<geode::Function<void(Event*)>> m_listeners;
+            // Progress is delivered at most once per frame; values posted in
+            // between replace each other here instead of each being queued
+            std::optional<P> m_pendingProgress;
+            bool m_progressQueued = false;
+            // Set on tasks created by `map`, lets the next `map` take over this
+            // task's place in the chain instead of listening to it
+            geode::Function<bool(geode::Function<void(Event*)>&&)> m_fuse;
+        #endif
 
             class PrivateMarker final {};
 
             static std::shared_ptr<Handle> create(std::string name) {
-                return std::make_shared<Handle>(PrivateMarker(), std::move(name));
+                return utils::makePooledShared<Handle>(PrivateMarker(), std::move(name));
             }
 
             bool is(Status status) {
@@ -298,6 +316,13 @@ namespace geode {
             if (handle->m_status == Status::Pending) {
                 handle->m_status = Status::Finished;
                 handle->m_resultValue.emplace(std::move(value));
+            #ifdef GEODE_TASK_HANDLE_V2
+                // SAFETY: Task::all() depends on the lifetime of the value pointer
+                // being as long as the lifetime of the task itself
+                queueInMainThread([handle]() {
+                    Task::deliverFinal(handle);
+                });
+            #else
                 queueInMainThread([handle, value = &*handle->m_resultValue]() mutable {
                     // SAFETY: Task::all() depends on the lifetime of the value pointer
                     // being as long as the lifetime of the task itself
@@ -305,15 +330,26 @@ namespace geode {
                     std::unique_lock<std::recursive_mutex> lock(handle->m_mutex);
                     handle->m_finalEventPosted = true;
                 });
+            #endif
             }
         }
         static void progress(std::shared_ptr<Handle> handle, P&& value) {
             if (!handle) return;
             std::unique_lock<std::recursive_mutex> lock(handle->m_mutex);
             if (handle->m_status == Status::Pending) {
+            #ifdef GEODE_TASK_HANDLE_V2
+                handle->m_pendingProgress.emplace(std::move(value));
+                if (!handle->m_progressQueued) {
+                    handle->m_progressQueued = true;
+                    queueInMainThread([handle]() {
+                        Task::deliverProgress(handle);
+                    });
+                }
+            #else
                 queueInMainThread([handle, value = std::move(value)]() mutable {
                     // Event::createProgressed(handle, &value).post();
                 });
+            #endif
             }
         }
         static void cancel(std::shared_ptr<Handle> handle, bool shallow = false) {
@@ -326,13 +362,218 @@ namespace geode {
                 if (!shallow && handle->m_extraData) {
                     handle->m_extraData->cancel();
                 }
+            #ifdef GEODE_TASK_HANDLE_V2
+                queueInMainThread([handle]() {
+                    Task::deliverFinal(handle);
+                });
+            #else
                 queueInMainThread([handle]() mutable {
                     // Event::createCancelled(handle).post();
                     std::unique_lock<std::recursive_mutex> lock(handle->m_mutex);
                     handle->m_finalEventPosted = true;
                 });
+            #endif
+            }
+        }
+
+    #ifdef GEODE_TASK_HANDLE_V2
+        static Event finalEvent(std::shared_ptr<Handle> const& handle) {
+            if (handle->m_status == Status::Finished) {
+                return Event::createFinished(handle, &*handle->m_resultValue);
+            }
+            return Event::createCancelled(handle);
+        }
+        // Listeners are called with the handle unlocked, so they may freely
+        // call back into the task or add more listeners to it
+        static void deliverProgress(std::shared_ptr<Handle> const& handle) {
+            std::unique_lock<std::recursive_mutex> lock(handle->m_mutex);
+            handle->m_progressQueued = false;
+            if (handle->m_finalEventPosted || !handle->m_pendingProgress) return;
+
+            auto value = std::move(*handle->m_pendingProgress);
+            handle->m_pendingProgress.reset();
+            auto listeners = std::exchange(handle->m_listeners, {});
+            lock.unlock();
+
+            for (auto& listener : listeners) {
+                auto event = Event::createProgressed(handle, &value);
+                listener(&event);
+            }
+
+            // Keep the listeners that were added in the meantime
+            lock.lock();
+            for (auto& listener : handle->m_listeners) {
+                listeners.push_back(std::move(listener));
             }
+            handle->m_listeners = std::move(listeners);
         }
+        static void deliverFinal(std::shared_ptr<Handle> const& handle) {
+            std::unique_lock<std::recursive_mutex> lock(handle->m_mutex);
+            handle->m_finalEventPosted = true;
+            handle->m_pendingProgress.reset();
+            auto listeners = std::exchange(handle->m_listeners, {});
+            lock.unlock();
+
+            for (auto& listener : listeners) {
+                auto event = Task::finalEvent(handle);
+                listener(&event);
+            }
+        }
+        static void addListener(std::shared_ptr<Handle> const& handle, geode::Function<void(Event*)>&& listener) {
+            if (!handle) return;
+            std::unique_lock<std::recursive_mutex> lock(handle->m_mutex);
+            if (!handle->m_finalEventPosted) {
+                handle->m_listeners.push_back(std::move(listener));
+                return;
+            }
+            // Late listeners still get the final event, on the next frame
+            // like everyone else did
+            queueInMainThread([handle, listener = std::move(listener)]() mutable {
+                auto event = Task::finalEvent(handle);
+                listener(&event);
+            });
+        }
+
+        // The part of `map` that listens to the mapped Task. Normally it
+        // forwards everything to the Task created by the map, but once
+        // another map has been fused onto that Task, events go straight to the
+        // next stage without a Task of their own in between
+        template <class T2, class P2, class ResultMapper, class ProgressMapper, class OnCancelled>
+        struct MapStage final {
+            using Target = Task<T2, P2>;
+
+            std::recursive_mutex m_mutex;
+            std::weak_ptr<typename Target::Handle> m_target;
+            ResultMapper m_resultMapper;
+            ProgressMapper m_progressMapper;
+            OnCancelled m_onCancelled;
+            geode::Function<void(typename Target::Event*)> m_next;
+            bool m_done = false;
+
+            template <class RM, class PM, class OC>
+            MapStage(std::weak_ptr<typename Target::Handle> target, RM&& resultMapper, PM&& progressMapper, OC&& onCancelled)
+              : m_target(std::move(target)),
+                m_resultMapper(std::forward<RM>(resultMapper)),
+                m_progressMapper(std::forward<PM>(progressMapper)),
+                m_onCancelled(std::forward<OC>(onCancelled))
+            {}
+
+            void handle(Event* event) {
+                std::unique_lock<std::recursive_mutex> lock(m_mutex);
+                if (m_done) return;
+                if (auto v = event->getValue()) {
+                    m_done = true;
+                    auto value = m_resultMapper(v);
+                    if (m_next) {
+                        auto mapped = Target::Event::createFinished(nullptr, &value);
+                        m_next(&mapped);
+                    }
+                    else {
+                        Target::finish(m_target.lock(), std::move(value));
+                    }
+                }
+                else if (auto p = event->getProgress()) {
+                    auto value = m_progressMapper(p);
+                    if (m_next) {
+                        auto mapped = Target::Event::createProgressed(nullptr, &value);
+                        m_next(&mapped);
+                    }
+                    else {
+                        Target::progress(m_target.lock(), std::move(value));
+                    }
+                }
+                else if (event->isCancelled()) {
+                    m_done = true;
+                    m_onCancelled();
+                    if (m_next) {
+                        auto mapped = Target::Event::createCancelled(nullptr);
+                        m_next(&mapped);
+                    }
+                    else {
+                        Target::cancel(m_target.lock());
+                    }
+                }
+            }
+
+            bool fuse(geode::Function<void(typename Target::Event*)>&& next) {
+                std::unique_lock<std::recursive_mutex> lock(m_mutex);
+                if (m_done || m_next) return false;
+                m_next = std::move(next);
+                return true;
+            }
+        };
+
+        template <class ResultMapper, class ProgressMapper, class OnCancelled>
+        auto mapImpl(bool fuse, ResultMapper&& resultMapper, ProgressMapper&& progressMapper, OnCancelled&& onCancelled, std::string_view name) const {
+            using T2 = decltype(resultMapper(std::declval<Type*>()));
+            using P2 = decltype(progressMapper(std::declval<P*>()));
+
+            static_assert(std::is_move_constructible_v<T2>, "The type being mapped to must be move-constructible!");
+            static_assert(std::is_move_constructible_v<P2>, "The type being mapped to must be move-constructible!");
+
+            using Stage = MapStage<T2, P2, std::decay_t<ResultMapper>, std::decay_t<ProgressMapper>, std::decay_t<OnCancelled>>;
+
+            Task<T2, P2> task = Task<T2, P2>::Handle::create(fmt::format("{} <= {}", name, m_handle->m_name));
+            auto stage = utils::makePooledShared<Stage>(
+                task.m_handle,
+                std::forward<ResultMapper>(resultMapper),
+                std::forward<ProgressMapper>(progressMapper),
+                std::forward<OnCancelled>(onCancelled)
+            );
+            auto listener = [stage](Event* event) {
+                stage->handle(event);
+            };
+
+            // If this Task was made by another map and nothing else holds on
+            // to it (like in `task.map(a).map(b)`), take its place instead of
+            // listening to it; it won't be receiving anything anymore
+            if (
+                fuse && m_handle.use_count() == 1 && m_handle->m_fuse &&
+                m_handle->is(Status::Pending) && m_handle->m_fuse(listener)
+            ) {
+                std::unique_lock<std::recursive_mutex> lock(m_handle->m_mutex);
+                // ExtraData is a different type for every Task, so the new
+                // handle gets its own copy and the old one lets go of the data
+                if (auto extra = std::move(m_handle->m_extraData)) {
+                    task.m_handle->m_extraData = std::make_unique<typename Task<T2, P2>::Handle::ExtraData>(
+                        extra->ptr, extra->onDestroy, extra->onCancelled
+                    );
+                    extra->onDestroy = +[](void*) {};
+                }
+                m_handle->m_status = Status::Cancelled;
+                m_handle->m_finalEventPosted = true;
+            }
+            else {
+                // Lock the current task until we have managed to create our new one
+                std::unique_lock<std::recursive_mutex> lock(m_handle->m_mutex);
+
+                // If the current task is already done, map it right away
+                if (m_handle->m_status != Status::Pending) {
+                    auto event = Task::finalEvent(m_handle);
+                    listener(&event);
+                }
+                // Otherwise start listening and waiting for the current task to finish
+                else {
+                    task.m_handle->m_extraData = std::make_unique<typename Task<T2, P2>::Handle::ExtraData>(
+                        static_cast<void*>(new Task(*this)),
+                        +[](void* ptr) {
+                            delete static_cast<Task*>(ptr);
+                        },
+                        +[](void* ptr) {
+                            // Cancel the mapped task too
+                            static_cast<Task*>(ptr)->cancel();
+                        }
+                    );
+                    Task::addListener(m_handle, std::move(listener));
+                }
+            }
+
+            task.m_handle->m_fuse = [stage](geode::Function<void(typename Task<T2, P2>::Event*)>&& next) {
+                return stage->fuse(std::move(next));
+            };
+            return task;
+        }
+    #endif
 
         template <is_task_type T2, std::move_constructible P2>
         friend class Task;
@@ -661,7 +902,27 @@ namespace geode {
          * cancelled
          * @param name The name of the Task; used for debugging. The name of
          * the mapped task is appended to the end
+         * @note With GEODE_TASK_HANDLE_V2, mapping a Task returned by another
+         * `map` that nothing else holds on to, like in `task.map(a).map(b)`,
+         * fuses the two maps into one stage so that the intermediate Task can
+         * be dropped
          */
+    #ifdef GEODE_TASK_HANDLE_V2
+        template <class ResultMapper, class ProgressMapper, class OnCancelled>
+        auto map(ResultMapper&& resultMapper, ProgressMapper&& progressMapper, OnCancelled&& onCancelled, std::string_view name = "<Mapping Task>") const& {
+            return this->mapImpl(
+                false, std::forward<ResultMapper>(resultMapper), std::forward<ProgressMapper>(progressMapper),
+                std::forward<OnCancelled>(onCancelled), name
+            );
+        }
+        template <class ResultMapper, class ProgressMapper, class OnCancelled>
+        auto map(ResultMapper&& resultMapper, ProgressMapper&& progressMapper, OnCancelled&& onCancelled, std::string_view name = "<Mapping Task>") && {
+            return this->mapImpl(
+                true, std::forward<ResultMapper>(resultMapper), std::forward<ProgressMapper>(progressMapper),
+                std::forward<OnCancelled>(onCancelled), name
+            );
+        }
+    #else
         template <class ResultMapper, class ProgressMapper, class OnCancelled>
         auto map(ResultMapper&& resultMapper, ProgressMapper&& progressMapper, OnCancelled&& onCancelled, std::string_view name = "<Mapping Task>") const {
             using T2 = decltype(resultMapper(std::declval<Type*>()));
@@ -718,6 +979,7 @@ namespace geode {
             }
             return task;
         }
+    #endif
 
         /**
          * Create a new Task that listens to this Task and maps the values using
@@ -732,10 +994,22 @@ namespace geode {
          * the mapped Task to a desired type
          * @param name The name of the Task; used for debugging. The name of
          * the mapped task is appended to the end
-         */        template <class ResultMapper, class ProgressMapper>
+         */
+    #ifdef GEODE_TASK_HANDLE_V2
+        template <class ResultMapper, class ProgressMapper>
+        auto map(ResultMapper&& resultMapper, ProgressMapper&& progressMapper, std::string_view name = "<Mapping Task>") const& {
+            return this->map(std::move(resultMapper), std::move(progressMapper), +[]() {}, name);
+        }
+        template <class ResultMapper, class ProgressMapper>
+        auto map(ResultMapper&& resultMapper, ProgressMapper&& progressMapper, std::string_view name = "<Mapping Task>") && {
+            return std::move(*this).map(std::move(resultMapper), std::move(progressMapper), +[]() {}, name);
+        }
+    #else
+        template <class ResultMapper, class ProgressMapper>
         auto map(ResultMapper&& resultMapper, ProgressMapper&& progressMapper, std::string_view name = "<Mapping Task>") const {
             return this->map(std::move(resultMapper), std::move(progressMapper), +[]() {}, name);
         }
+    #endif
 
         /**
          * Create a new Task that listens to this Task and maps the finish value
@@ -749,11 +1023,25 @@ namespace geode {
          * copyable - the mapper may NOT move out of the value!
          * @param name The name of the Task; used for debugging. The name of
          * the mapped task is appended to the end
-         */        template <class ResultMapper>
+         */
+    #ifdef GEODE_TASK_HANDLE_V2
+        template <class ResultMapper>
+            requires std::copy_constructible<P>
+        auto map(ResultMapper&& resultMapper, std::string_view name = "<Mapping Task>") const& {
+            return this->map(std::move(resultMapper), +[](P* p) -> P { return *p; }, name);
+        }
+        template <class ResultMapper>
+            requires std::copy_constructible<P>
+        auto map(ResultMapper&& resultMapper, std::string_view name = "<Mapping Task>") && {
+            return std::move(*this).map(std::move(resultMapper), +[](P* p) -> P { return *p; }, name);
+        }
+    #else
+        template <class ResultMapper>
             requires std::copy_constructible<P>
         auto map(ResultMapper&& resultMapper, std::string_view name = "<Mapping Task>") const {
             return this->map(std::move(resultMapper), +[](P* p) -> P { return *p; }, name);
         }
+    #endif
 
         /**
          * Creates an implicit event listener for this Task that will call the
@@ -770,6 +1058,26 @@ namespace geode {
          */
         template <class OnResult, class OnProgress, class OnCancelled>
         void listen(OnResult&& onResult, OnProgress&& onProgress, OnCancelled&& onCancelled) const {
+        #ifdef GEODE_TASK_HANDLE_V2
+            // The listener holds on to the Task until it's done, after which
+            // the Task drops its listeners and with that the cycle is broken
+            Task::addListener(m_handle, [
+                task = *this,
+                onResult = std::move(onResult),
+                onProgress = std::move(onProgress),
+                onCancelled = std::move(onCancelled)
+            ](Event* event) mutable {
+                if (auto v = event->getValue()) {
+                    onResult(v);
+                }
+                else if (auto p = event->getProgress()) {
+                    onProgress(p);
+                }
+                else if (event->isCancelled()) {
+                    onCancelled();
+                }
+            });
+        #else
             // use a raw pointer to avoid cyclic references,
             // we destroy it manually later on
             // auto* listener = new EventListener<Task>(*this);
@@ -799,6 +1107,7 @@ namespace geode {
             //         });
             //     }
             // });
+        #endif
         }
 
         /**
@@ -867,6 +1176,53 @@ namespace geode {
 
             NewTask task = NewTask::Handle::create(fmt::format("{} <- {}", name, m_handle->m_name));
 
+        #ifdef GEODE_TASK_HANDLE_V2
+            task.m_handle->m_extraData = std::make_unique<typename Handle::ExtraData>(
+                static_cast<void*>(new Task(*this)),
+                +[](void* ptr) {
+                    delete static_cast<Task*>(ptr);
+                },
+                +[](void* ptr) {
+                    static_cast<Task*>(ptr)->cancel();
+                }
+            );
+            // wait for the current task, then run the mapper and wait for the
+            // task it created, forwarding everything from that one through
+            Task::addListener(m_handle, [handle = std::weak_ptr(task.m_handle), mapper = std::move(mapper)](Event* event) mutable {
+                if (auto v = event->getValue()) {
+                    auto newInnerTask = mapper(v);
+                    auto lock = handle.lock();
+                    if (!lock) return;
+                    NewTask::addListener(newInnerTask.m_handle, [handle](typename NewTask::Event* event) {
+                        if (auto v = event->getValue()) {
+                            NewTask::finish(handle.lock(), std::move(*v));
+                        }
+                        else if (auto p = event->getProgress()) {
+                            NewTask::progress(handle.lock(), std::move(*p));
+                        }
+                        else if (event->isCancelled()) {
+                            NewTask::cancel(handle.lock());
+                        }
+                    });
+                    // the wrapper now owns the inner task instead of this one
+                    std::unique_lock<std::recursive_mutex> guard(lock->m_mutex);
+                    lock->m_extraData = std::make_unique<typename NewTask::Handle::ExtraData>(
+                        static_cast<void*>(new NewTask(std::move(newInnerTask))),
+                        +[](void* ptr) {
+                            delete static_cast<NewTask*>(ptr);
+                        },
+                        +[](void* ptr) {
+                            static_cast<NewTask*>(ptr)->cancel();
+                        }
+                    );
+                }
+                // no guarantee P and NewProgress are compatible,
+                // so progress of this task isn't forwarded
+                else if (event->isCancelled()) {
+                    NewTask::cancel(handle.lock());
+                }
+            });
+        #else
             // task.m_handle->m_extraData = std::make_unique<typename NewTask::Handle::ExtraData>(
             //     // make the first event listener that waits for the current task
             //     // static_cast<void*>(new EventListener<Task>(
@@ -917,6 +1273,7 @@ namespace geode {
             //         // static_cast<EventListener<Task>*>(ptr)->getFilter().cancel();
             //     }
             // );
+        #endif
             return task;
         }
 
@@ -999,7 +1356,7 @@ namespace geode {
 namespace geode {
     namespace geode_internal {
         template <class T, class P>
-        struct TaskPromiseBase {
+        struct TaskPromiseBase : public utils::PooledFrame {
             using MyTask = Task<T, P>;
             std::weak_ptr<typename MyTask::Handle> m_handle;
 
@@ -1075,6 +1432,30 @@ namespace geode {
                     handle.destroy();
                     return;
                 }
+            #ifdef GEODE_TASK_HANDLE_V2
+                // the parent owns the awaited task, so cancelling the parent
+                // cancels it too
+                {
+                    std::unique_lock<std::recursive_mutex> lock(parentHandle->m_mutex);
+                    parentHandle->m_extraData = std::make_unique<typename Task<U, V>::Handle::ExtraData>(
+                        static_cast<void*>(new Task<T, P>(task)),
+                        +[](void* ptr) {
+                            delete static_cast<Task<T, P>*>(ptr);
+                        },
+                        +[](void* ptr) {
+                            static_cast<Task<T, P>*>(ptr)->cancel();
+                        }
+                    );
+                }
+                Task<T, P>::addListener(task.m_handle, [handle](auto* event) {
+                    if (event->getValue()) {
+                        handle.resume();
+                    }
+                    else if (event->isCancelled()) {
+                        handle.destroy();
+                    }
+                });
+            #else
                 // parentHandle->m_extraData = std::make_unique<typename Task<U, V>::Handle::ExtraData>(
                 //     // static_cast<void*>(new EventListener<Task<T, P>>(
                 //     //     [handle](auto* event) {
@@ -1094,6 +1475,7 @@ namespace geode {
                 //         // static_cast<EventListener<Task<T, P>>*>(ptr)->getFilter().cancel();
                 //     }
                 // );
+            #endif
             }
 
             Task<T, P>::Type await_resume() {
@@ -5,13 +5,93 @@
 #include <arc/util/Result.hpp>
 #include <arc/task/CancellationToken.hpp>
 #include <Geode/utils/function.hpp>
+#include <Geode/utils/FramePool.hpp>
 #include <Geode/loader/Loader.hpp>
+#include <Geode/loader/Watchdog.hpp>
+#include <chrono>
+#include <utility>
+#include <vector>
 
 namespace geode::async {
 
 /// Gets the main arc Runtime, prefer running all async code inside this runtime.
 GEODE_DLL arc::Runtime& runtime();
 
+/// Number of worker threads in the main runtime. Picked from the core count,
+/// unless set with the `async-worker-threads` setting or the `async-workers` launch argument
+GEODE_DLL size_t workerCount();
+
+/// Statistics about tasks spawned with a main thread callback (`spawn(future, callback)`
+/// and `TaskHolder`), for tuning the worker count. Other tasks aren't tracked
+struct RuntimeStats {
+    struct Worker {
+        /// Time spent polling tracked tasks on this thread
+        std::chrono::nanoseconds busyTime{0};
+        size_t polls = 0;
+        /// Share of the time since this worker first polled a tracked task that it spent polling
+        double utilization = 0.0;
+    };
+    size_t workerCount = 0;
+    /// Tasks that were spawned but haven't been polled yet
+    size_t queuedTasks = 0;
+    /// Tasks that have started but haven't finished
+    size_t runningTasks = 0;
+    /// Tasks that finished or were cancelled
+    size_t completedTasks = 0;
+    std::vector<Worker> workers;
+};
+GEODE_DLL RuntimeStats runtimeStats();
+
+namespace _detail {
+    GEODE_DLL void taskSpawned() noexcept;
+    GEODE_DLL void taskStarted() noexcept;
+    GEODE_DLL void taskFinished() noexcept;
+    GEODE_DLL void taskPolled(std::chrono::nanoseconds time) noexcept;
+
+    // Counts a task through its lifetime, moves along with the pollable
+    class TaskTracker {
+        enum class State : uint8_t { None, Queued, Running };
+        State m_state = State::Queued;
+
+    public:
+        TaskTracker() noexcept {
+            taskSpawned();
+        }
+        TaskTracker(TaskTracker&& other) noexcept : m_state(std::exchange(other.m_state, State::None)) {}
+        TaskTracker& operator=(TaskTracker&& other) noexcept {
+            if (this != &other) {
+                this->finish();
+                m_state = std::exchange(other.m_state, State::None);
+            }
+            return *this;
+        }
+        ~TaskTracker() {
+            this->finish();
+        }
+
+        void start() noexcept {
+            if (m_state == State::Queued) {
+                taskStarted();
+                m_state = State::Running;
+            }
+        }
+        void finish() noexcept {
+            this->start();
+            if (m_state == State::Running) {
+                taskFinished();
+                m_state = State::None;
+            }
+        }
+    };
+
+    struct PollTimer {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ~PollTimer() {
+            taskPolled(std::chrono::steady_clock::now() - start);
+        }
+    };
+}
+
 /// Asynchronously spawns a future, then invokes the given callback on the main thread when it completes.
 /// Overload for function objects that return a Future, i.e. `[] -> arc::Future {}`
 template <
@@ -24,36 +104,65 @@ arc::TaskHandle<void> spawn(Lambda&& lambda, Cb&& cb) {
     using Out = arc::FutureTraits<Fut>::Output;
     constexpr bool Void = std::is_void_v<Out>;
 
+    using Callback = std::decay_t<Cb>;
+
+    // Everything but the tracker lives in one block from the frame pool, so
+    // the task arc allocates stays small, and handing the callback and its
+    // result to the main thread only moves a pooled pointer, which fits in
+    // the queued function without another allocation
+    struct SpawnState {
+        SpawnState(Lambda&& f, Cb&& c) : func(std::in_place, std::forward<Lambda>(f)), callback(std::forward<Cb>(c)) {}
+
+        std::optional<Func> func;
+        std::optional<Fut> fut;
+        Callback callback;
+        std::optional<std::conditional_t<Void, std::monostate, Out>> result;
+    };
+
     struct SpawnPollable : arc::Pollable<SpawnPollable, void> {
-        explicit SpawnPollable(Lambda&& f, Cb&& c) : m_func(std::forward<Lambda>(f)), m_callback(std::forward<Cb>(c)) {}
+        explicit SpawnPollable(Lambda&& f, Cb&& c)
+            : m_state(utils::makePooledShared<SpawnState>(std::forward<Lambda>(f), std::forward<Cb>(c))) {}
 
         bool poll(arc::Context& cx) {
-            if (!m_fut) {
-                m_fut.emplace(std::invoke(m_func));
+            _detail::PollTimer timer;
+            auto& state = *m_state;
+            if (!state.fut) {
+                m_tracker.start();
+                state.fut.emplace(std::invoke(*state.func));
             }
 
-            if (!m_fut->m_vtable->poll(&*m_fut, cx)) {
+            if (!state.fut->m_vtable->poll(&*state.fut, cx)) {
                 return false;
             }
+            m_tracker.finish();
+
+            if constexpr (!Void) {
+                state.result.emplace(std::move(state.fut->m_vtable->template getOutput<Out>(&*state.fut)));
+            }
+            // the future may refer to the function that made it, so it goes first
+            state.fut.reset();
+            state.func.reset();
 
             if constexpr (Void) {
                 static_assert(std::is_invocable_v<Cb>, "When spawning a void future, callback must be invocable with no arguments");
 
                 // scary things
-                geode::queueInMainThread(std::move(*m_callback));
-                m_callback.reset();
+                geode::queueInMainThread([state = std::move(m_state)] mutable {
+                    watchdog::Scope scope(geode::getMod(), "async callback");
+                    state->callback();
+                });
             } else {
                 // more scary things
-                geode::queueInMainThread([cb = std::move(*m_callback), result = std::move(m_fut->m_vtable->template getOutput<Out>(&*m_fut))] mutable {
+                geode::queueInMainThread([state = std::move(m_state)] mutable {
+                    watchdog::Scope scope(geode::getMod(), "async callback");
                     if constexpr (std::is_invocable_v<Cb, Out>) {
-                        cb(std::move(result));
+                        state->callback(std::move(*state->result));
                     } else if constexpr (std::is_invocable_v<Cb>) {
-                        cb();
+                        state->callback();
                     } else {
                         static_assert(!std::is_same_v<Cb, Cb>, "When spawning a future, callback must be invocable with the future's output or with no arguments");
                     }
                 });
-                m_callback.reset();
             }
 
             return true;
@@ -63,17 +172,18 @@ arc::TaskHandle<void> spawn(Lambda&& lambda, Cb&& cb) {
         SpawnPollable& operator=(SpawnPollable&&) = default;
 
         ~SpawnPollable() {
-            if (m_callback) {
+            if (m_state) {
                 // Task was cancelled before it could finish, we should schedule the callback to be destroyed on main thread,
                 // because mods may do things like capture Refs, which must be destroyed on main thread
-                geode::queueInMainThread([cb = std::move(*m_callback)] {});
+                m_state->fut.reset();
+                m_state->func.reset();
+                geode::queueInMainThread([state = std::move(m_state)] {});
             }
         }
 
     private:
-        Func m_func;
-        std::optional<Cb> m_callback;
-        std::optional<Fut> m_fut;
+        std::shared_ptr<SpawnState> m_state;
+        _detail::TaskTracker m_tracker;
     };
 
     return runtime().spawn(SpawnPollable {
@@ -107,7 +217,9 @@ template <
 struct WaitForMainAwaiter : arc::Pollable<WaitForMainAwaiter<T>, PollOut> {
     template <typename F> requires (!std::is_same_v<std::decay_t<F>, WaitForMainAwaiter>)
     explicit WaitForMainAwaiter(F&& func) {
-        m_state = std::make_shared<std::atomic<State>>(State::Pending);
+        m_state = std::allocate_shared<std::atomic<State>>(
+            utils::FramePoolAllocator<std::atomic<State>>(), State::Pending
+        );
         auto [tx, rx] = arc::oneshot::channel<NonVoidT>();
         m_receiver.emplace(std::move(rx));
         m_recvAwaiter.emplace(m_receiver->recv());
@@ -322,7 +434,7 @@ private:
 
         this->cancel();
 
-        auto state = std::make_shared<SpawnedTaskState>();
+        auto state = std::allocate_shared<SpawnedTaskState>(utils::FramePoolAllocator<SpawnedTaskState>());
 
         if constexpr (std::is_void_v<Ret>) {
             state->m_handle = geode::async::spawn(std::forward<F>(future), [state, cb = std::forward<Cb>(cb)] mutable {
@@ -3,6 +3,7 @@
 #include <coroutine>
 #include <Geode/DefaultInclude.hpp>
 #include "Task.hpp"
+#include "FramePool.hpp"
 #include <concepts>
 #include <arc/future/Future.hpp>
 
@@ -15,7 +16,7 @@ namespace geode::utils::coro {
     class Generator final {
         using StoredT = std::conditional_t<std::is_reference_v<T>, std::reference_wrapper<std::remove_reference_t<T>>, T>;
     public:
-        struct promise_type {
+        struct promise_type : public PooledFrame {
             std::optional<StoredT> m_value;
 
             Generator get_return_object() {
@@ -156,7 +157,7 @@ namespace geode::utils::coro {
     GEODE_DLL arc::Future<void> skipFrames(int frames);
 
     template <typename T, typename E>
-    struct BaseResultPromise {
+    struct BaseResultPromise : public PooledFrame {
         std::optional<Result<T, E>>* result;
 
         struct return_object {
@@ -167,7 +168,13 @@ namespace geode::utils::coro {
         };
 
         std::suspend_never initial_suspend() const noexcept { return {}; }
-        std::suspend_always final_suspend() const noexcept { return {}; }
+        // The frame frees itself once the body returns. The return object
+        // only owns the result, which lives outside of the frame, so nothing
+        // holds the handle to destroy it later; with suspend_always every
+        // frame that ran to the end leaked. The only other destroy() is
+        // ResultAwaiter bailing out on an error, which happens while the
+        // body is suspended at that co_await and never reaches this point
+        std::suspend_never final_suspend() const noexcept { return {}; }
         return_object get_return_object() noexcept {
             auto ptr = std::make_unique<std::optional<Result<T, E>>>();
             result = &*ptr;
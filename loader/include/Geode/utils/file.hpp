@@ -44,6 +44,15 @@ namespace geode::utils::file {
     GEODE_DLL Result<matjson::Value> readJson(std::filesystem::path const& path);
     GEODE_DLL Result<ByteVector> readBinary(std::filesystem::path const& path);
 
+    /**
+     * Calculate the CRC32 of a file, the same checksum zips store for their
+     * entries
+     *
+     * @param path Path to the file to read
+     * @returns The checksum, or an error if the file couldn't be read
+     */
+    GEODE_DLL Result<uint32_t> readCRC32(std::filesystem::path const& path);
+
     template <class T>
     Result<T> readFromJson(std::filesystem::path const& file) {
         GEODE_UNWRAP_INTO(auto json, readJson(file));
@@ -221,10 +230,23 @@ namespace geode::utils::file {
          */
         Path getPath() const;
 
+        struct EntryInfo {
+            Path path;
+            bool isDirectory = false;
+            // Uncompressed size
+            uint64_t size = 0;
+            uint32_t crc32 = 0;
+        };
+
         /**
          * Get all entries in zip
          */
         std::vector<Path> getEntries() const;
+        /**
+         * Get all entries in zip along with their size and checksum, as
+         * listed in the central directory. Nothing is decompressed
+         */
+        std::vector<EntryInfo> getEntryInfo() const;
         /**
          * Check if zip has entry
          * @param name Entry path in zip
@@ -247,6 +269,15 @@ namespace geode::utils::file {
          * @param dir Directory to unzip the contents to
          */
         Result<> extractAllTo(Path const& dir);
+        /**
+         * Go through the entries in the order of the central directory,
+         * extracting the ones the callback returns a target file path for.
+         * Unlike calling `extractTo` for each entry, every entry is only
+         * looked up once
+         * @param callback Called with every entry, including directories.
+         * Returns where to extract the entry to, or nullopt to skip it
+         */
+        Result<> extractEach(geode::Function<std::optional<Path>(EntryInfo const&)> callback);
 
         /**
          * Helper method for quickly unzipping a file
@@ -12,10 +12,16 @@ inline void hashCombine(size_t& seed, T const& v) {
     seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
+/**
+ * Hash of the mangled type name of T. The name is only hashed the
+ * first time this is called for a given type, after that the cached
+ * value is returned. The value is derived from the type name, so it
+ * is the same across every module that instantiates it.
+ */
 template <class T>
 inline size_t typenameHash() {
-    std::hash<std::string_view> hasher;
-    return hasher(typeid(T).name());
+    static size_t const s_hash = std::hash<std::string_view>{}(typeid(T).name());
+    return s_hash;
 }
 
 }
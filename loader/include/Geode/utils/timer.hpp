@@ -1,6 +1,15 @@
 #pragma once
 
+#include <Geode/platform/platform.hpp>
+#include <Geode/Result.hpp>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace geode::utils {
     template <typename T>
@@ -82,4 +91,113 @@ namespace geode::utils {
                      << m_timer.template elapsedAsString<Duration>() << std::endl;
         }
     };
+
+    /**
+     * Low-overhead zone profiler. Code marks zones with `GEODE_PROFILE_ZONE`,
+     * which when the profiler is enabled records the start and end of the
+     * zone into a ring buffer owned by the current thread. The recorded zones
+     * of every thread can be exported as a Chrome trace, which can be opened
+     * in Perfetto or `chrome://tracing`.
+     * While disabled, a zone costs one relaxed atomic load, and doesn't call
+     * into the loader. Zone names are only interned once the profiler has
+     * been enabled
+     */
+    namespace profiler {
+        // Interned zone name; 0 is never a valid zone
+        using ZoneID = uint32_t;
+
+        struct ZoneRecord {
+            ZoneID zone = 0;
+            // Index of the recording thread, in order of their first zone
+            uint32_t thread = 0;
+            // Nanoseconds since the profiler's epoch
+            int64_t start = 0;
+            int64_t end = 0;
+        };
+
+        namespace detail {
+            // Exported so that isEnabled can be inlined into every zone
+            GEODE_DLL extern std::atomic_bool enabled;
+        }
+
+        GEODE_DLL void setEnabled(bool enabled);
+        inline bool isEnabled() noexcept {
+            return detail::enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Get the ID for a zone name, adding it if it doesn't exist yet.
+         * Takes a lock, so IDs should be looked up once and cached, which is
+         * what `GEODE_PROFILE_ZONE` does
+         */
+        GEODE_DLL ZoneID internZone(std::string_view name);
+        GEODE_DLL std::string getZoneName(ZoneID zone);
+
+        /// Nanoseconds since the profiler's epoch, on a steady clock
+        GEODE_DLL int64_t now() noexcept;
+        /**
+         * Record a zone on the current thread. Each thread keeps its last 16384
+         * zones, older ones are overwritten. A thread's buffer is only allocated
+         * the first time it records while the profiler is enabled
+         */
+        GEODE_DLL void record(ZoneID zone, int64_t start, int64_t end) noexcept;
+
+        /**
+         * Get all recorded zones of every thread, ordered by start time. May be
+         * called while other threads are recording
+         */
+        GEODE_DLL std::vector<ZoneRecord> collect();
+        /// Drop every recorded zone, and free the buffers of threads that have
+        /// exited. Zone names are kept
+        GEODE_DLL void clear();
+
+        /// Recorded zones in the Chrome trace event JSON format
+        GEODE_DLL std::string exportChromeTrace();
+        GEODE_DLL Result<> writeChromeTrace(std::filesystem::path const& path);
+
+        class Zone final {
+            ZoneID m_zone = 0;
+            int64_t m_start = 0;
+
+        public:
+            Zone(ZoneID zone) noexcept
+              : m_zone(isEnabled() ? zone : 0), m_start(m_zone ? now() : 0) {}
+            /**
+             * Interns the name into `id` the first time the zone is entered
+             * while the profiler is enabled
+             */
+            Zone(std::atomic<ZoneID>& id, std::string_view name) noexcept {
+                if (!isEnabled()) return;
+                m_zone = id.load(std::memory_order_relaxed);
+                if (!m_zone) {
+                    // racing threads intern the same name, so they agree on the ID
+                    m_zone = internZone(name);
+                    id.store(m_zone, std::memory_order_relaxed);
+                }
+                m_start = now();
+            }
+            ~Zone() noexcept {
+                if (m_zone) record(m_zone, m_start, now());
+            }
+            Zone(Zone const&) = delete;
+            Zone& operator=(Zone const&) = delete;
+        };
+    }
 }
+
+#if !defined(GEODE_CONCAT)
+    #define GEODE_WRAPPER_CONCAT(x, y) x##y
+    #define GEODE_CONCAT(x, y) GEODE_WRAPPER_CONCAT(x, y)
+#endif
+
+// Profile the rest of the enclosing scope as a zone. The name is interned
+// the first time the line runs while profiling, so it must be the same every
+// time. The ID is constant initialized, so there's no guard to check
+#define GEODE_PROFILE_ZONE(name)                                                          \
+    static constinit ::std::atomic<::geode::utils::profiler::ZoneID> GEODE_CONCAT(geodeProfileZoneID, __LINE__) = 0; \
+    ::geode::utils::profiler::Zone GEODE_CONCAT(geodeProfileZone, __LINE__)(              \
+        GEODE_CONCAT(geodeProfileZoneID, __LINE__), name                                  \
+    )
+
+// Profile the rest of the enclosing function, named after the function
+#define GEODE_PROFILE_FUNCTION() GEODE_PROFILE_ZONE(GEODE_PRETTY_FUNCTION)
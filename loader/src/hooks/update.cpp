@@ -1,4 +1,5 @@
 #include <loader/LoaderImpl.hpp>
+#include <loader/WatchdogImpl.hpp>
 
 using namespace geode::prelude;
 
@@ -6,6 +7,7 @@ using namespace geode::prelude;
 
 struct FunctionQueue : Modify<FunctionQueue, CCScheduler> {
     void update(float dt) {
+        watchdog::onFrame();
         LoaderImpl::get()->executeMainThreadQueue();
         return CCScheduler::update(dt);
     }
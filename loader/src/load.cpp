@@ -162,6 +162,10 @@ int geodeEntry(void* platformData) {
         console::openIfClosed();
     }
 
+    // The logger's thread is the first thing to start the async runtime, which
+    // is sized from the `async-workers` launch argument, so read those first
+    LoaderImpl::get()->setupLaunchArguments();
+
     // Setup logger here so that internal mod is setup and we can read log level
     // Logging before this point does store the log, and everything gets logged in this setup call
     log::Logger::get()->setup();
@@ -1,139 +1,639 @@
 #include <Geode/loader/Event.hpp>
+#include <Geode/utils/MPSCQueue.hpp>
 #include <Geode/utils/ranges.hpp>
+#include <Geode/utils/timer.hpp>
+#include <array>
 #include <mutex>
+#include <thread>
 
 using namespace geode::prelude;
 using namespace geode::comm;
 
+namespace {
+    // Thread local centers take their generations from one counter, so a
+    // center allocated where an exited thread's center used to be can't
+    // repeat a generation an EventSender has already seen
+    size_t nextGeneration() noexcept {
+        static std::atomic_size_t s_next = 1;
+        return s_next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    struct PortEntry {
+        std::shared_ptr<OpaquePortBase> port;
+        // Latest port version this port has been checked against,
+        // 0 means it has to be checked by every caller
+        PortVersion version = 0;
+
+        OpaquePortBase* ensureVersion(EventCenterThreadLocal::MigrateFuncType& migratePort, PortVersion callerVersion, std::atomic_size_t& generation) {
+            if (callerVersion == 0 || version < callerVersion) {
+                if (auto newPort = std::invoke(migratePort, port.get())) {
+                    port.reset(newPort);
+                    // senders bound to the old port need to look it up again
+                    generation.store(nextGeneration(), std::memory_order_release);
+                }
+                version = std::max(version, callerVersion);
+            }
+            return port.get();
+        }
+    };
+
+    using LocalPortMap = std::unordered_map<std::shared_ptr<BaseFilter>, PortEntry, BaseFilterHash, BaseFilterEqual>;
+}
+
 // EventCenterThreadLocal
 
 class EventCenterThreadLocal::Impl {
 public:
-    using KeyType = std::shared_ptr<BaseFilter>;
-    using ValueType = std::shared_ptr<OpaquePortBase>;
-    using MapType = std::unordered_map<KeyType, ValueType, BaseFilterHash, BaseFilterEqual>;
+    // A removal requested from a thread other than the one owning the listener
+    struct DeferredRemoval {
+        std::weak_ptr<BaseFilter> filter;
+        RemoveFuncType func;
+        MigrateFuncType migratePort;
+        PortVersion version;
+    };
+
+    // Which thread's event center owns a given filter key, so that listener
+    // handles destroyed on another thread can find the right one
+    struct Registry {
+        struct Owner {
+            Impl* impl;
+            std::weak_ptr<BaseFilter> filter;
+        };
+
+        std::mutex mutex;
+        std::unordered_map<BaseFilter const*, Owner> owners;
+
+        // Held while touching a dead center, see DeadScope. Recursive since
+        // destroying a receiver may remove another listener of a dead center
+        std::recursive_mutex deadMutex;
+        size_t deadDepth = 0;
+        // Dead centers that lost their last port, freed once the outermost
+        // DeadScope ends so that nothing nested is still using them
+        std::vector<EventCenterThreadLocal*> graveyard;
+
+        static Registry& get() {
+            static auto s_registry = new Registry();
+            return *s_registry;
+        }
+    };
+
+    LocalPortMap m_ports;
+    std::atomic_size_t m_generation = nextGeneration();
+    utils::MPSCQueue<DeferredRemoval> m_removals;
+    // Only the centers of getForCurrentThread() hand removals between threads
+    bool m_perThread = false;
+    EventCenterThreadLocal* m_center = nullptr;
+    // Set under the registry lock once the owning thread has exited with
+    // ports left. Removals for it are then applied right away by whichever
+    // thread asks, instead of queued for a thread that's gone
+    bool m_dead = false;
+    bool m_buried = false;
+
+    // Lets the current thread touch dead centers
+    class DeadScope {
+        Registry& m_registry = Registry::get();
+        std::lock_guard<std::recursive_mutex> m_lock{m_registry.deadMutex};
+
+    public:
+        DeadScope() {
+            m_registry.deadDepth += 1;
+        }
+        ~DeadScope() {
+            if (--m_registry.deadDepth > 0) return;
+            for (auto center : std::exchange(m_registry.graveyard, {})) {
+                delete center;
+            }
+        }
 
-    MapType m_ports;
+        // Frees the center once the outermost scope ends, if it has no ports left
+        void bury(Impl* impl) {
+            if (impl->m_ports.empty() && !impl->m_buried) {
+                impl->m_buried = true;
+                m_registry.graveyard.push_back(impl->m_center);
+            }
+        }
+    };
+
+    void registerPort(std::shared_ptr<BaseFilter> const& filter) {
+        if (!m_perThread) return;
+        auto& registry = Registry::get();
+        std::lock_guard lock(registry.mutex);
+        registry.owners.insert_or_assign(filter.get(), Registry::Owner{this, filter});
+    }
+
+    void erasePort(LocalPortMap::iterator it) {
+        if (m_perThread) {
+            auto& registry = Registry::get();
+            std::lock_guard lock(registry.mutex);
+            registry.owners.erase(it->first.get());
+        }
+        m_ports.erase(it);
+    }
+
+    // Hands a removal off to the thread owning the filter, or applies it
+    // right away if that thread has exited. Returns false if no center
+    // owns the filter anymore
+    static bool deferRemoval(BaseFilter const* filter, RemoveFuncType& func, MigrateFuncType& migratePort, PortVersion version) {
+        auto& registry = Registry::get();
+        {
+            std::lock_guard lock(registry.mutex);
+            auto it = registry.owners.find(filter);
+            if (it == registry.owners.end()) {
+                return false;
+            }
+            if (!it->second.impl->m_dead) {
+                // pushed under the registry lock so the owner can't go away in between
+                it->second.impl->m_removals.push(DeferredRemoval{
+                    it->second.filter, std::move(func), std::move(migratePort), version
+                });
+                return true;
+            }
+        }
+
+        // dead centers are only changed and freed under the dead lock, so
+        // the owner found here stays valid until the scope ends
+        DeadScope scope;
+        Impl* impl = nullptr;
+        std::shared_ptr<BaseFilter> key;
+        {
+            std::lock_guard lock(registry.mutex);
+            auto it = registry.owners.find(filter);
+            if (it == registry.owners.end()) {
+                return false;
+            }
+            if (!it->second.impl->m_dead) {
+                // the dead port went away and a live one took its key
+                it->second.impl->m_removals.push(DeferredRemoval{
+                    it->second.filter, std::move(func), std::move(migratePort), version
+                });
+                return true;
+            }
+            impl = it->second.impl;
+            key = it->second.filter.lock();
+        }
+        auto it = impl->m_ports.find(key.get());
+        if (key && it != impl->m_ports.end() && it->first == key) {
+            impl->removeFrom(it, func, migratePort, version);
+        }
+        scope.bury(impl);
+        return true;
+    }
+
+    size_t removeFrom(LocalPortMap::iterator it, RemoveFuncType& func, MigrateFuncType& migratePort, PortVersion version) {
+        auto size = std::invoke(func, it->second.ensureVersion(migratePort, version, m_generation));
+        if (size == 0) {
+            // geode::console::log(fmt::format("Removing port for filter type {}", cast::getRuntimeTypeName(filter)), Severity::Debug);
+            this->erasePort(it);
+        }
+        return size;
+    }
+
+    void processRemovals() {
+        if (m_removals.empty()) return;
+
+        m_removals.drain([this](DeferredRemoval& removal) {
+            auto filter = removal.filter.lock();
+            if (!filter) return;
+
+            auto it = m_ports.find(filter.get());
+            if (it != m_ports.end() && it->first == filter) {
+                this->removeFrom(it, removal.func, removal.migratePort, removal.version);
+            }
+        });
+    }
 };
 
 EventCenterThreadLocal::EventCenterThreadLocal() : m_impl(std::make_unique<Impl>()) {}
 EventCenterThreadLocal::~EventCenterThreadLocal() = default;
 
 EventCenterThreadLocal* EventCenterThreadLocal::get() {
-    // TODO: make this back threadlocal
     static auto s_instance = new EventCenterThreadLocal();
     return s_instance;
 }
 
+EventCenterThreadLocal* EventCenterThreadLocal::getForCurrentThread() {
+    // When a thread exits, its center is only freed if nothing is registered
+    // on it anymore. Otherwise it is marked dead and kept, so listener
+    // destructors don't run during exit, until the handles outliving their
+    // thread have removed the rest, which is when it gets freed.
+    struct Holder {
+        EventCenterThreadLocal* center = new EventCenterThreadLocal();
+
+        Holder() {
+            center->m_impl->m_perThread = true;
+            center->m_impl->m_center = center;
+        }
+
+        ~Holder() {
+            auto impl = center->m_impl.get();
+            Impl::DeadScope scope;
+            {
+                std::lock_guard lock(Impl::Registry::get().mutex);
+                impl->m_dead = true;
+            }
+            // removals handed off before it was marked dead
+            impl->processRemovals();
+            scope.bury(impl);
+        }
+    };
+    static thread_local Holder s_holder;
+    return s_holder.center;
+}
+
 bool EventCenterThreadLocal::send(BaseFilter const* filter, SendFuncType func, MigrateFuncType migratePort) noexcept {
+    return this->send(filter, std::move(func), std::move(migratePort), 0);
+}
+ListenerHandle EventCenterThreadLocal::addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort) noexcept {
+    return this->addReceiver(filter, std::move(func), std::move(migratePort), 0);
+}
+size_t EventCenterThreadLocal::getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort) noexcept {
+    return this->getReceiverCount(filter, std::move(func), std::move(migratePort), 0);
+}
+size_t EventCenterThreadLocal::removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort) noexcept {
+    return this->removeReceiver(filter, std::move(func), std::move(migratePort), 0);
+}
+
+bool EventCenterThreadLocal::send(BaseFilter const* filter, SendFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept {
+    GEODE_PROFILE_ZONE("Event send");
     // log::debug("EventCenterThreadLocal sending event for filter {}, {}", (void*)filter, cast::getRuntimeTypeName(filter));
     // log::debug("hash {} threadid {}", BaseFilterHash{}(filter), std::this_thread::get_id());
+    m_impl->processRemovals();
 
     auto it = m_impl->m_ports.find(filter);
     if (it != m_impl->m_ports.end()) {
         // log::debug("found port for filter {}", (void*)it->first.get());
-        if (auto newPort = std::invoke(migratePort, it->second.get())) {
-            it->second.reset(newPort);
-        }
-        return std::invoke(func, it->second.get());
+        it->second.ensureVersion(migratePort, version, m_impl->m_generation);
+        // keep the port alive in case the last receiver removes itself while sending
+        auto port = it->second.port;
+        return std::invoke(func, port.get());
     }
     return false;
 }
-ListenerHandle EventCenterThreadLocal::addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort) noexcept {
+ListenerHandle EventCenterThreadLocal::addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept {
     // log::debug("EventCenterThreadLocal adding receiver for filter {}, {}", (void*)filter, cast::getRuntimeTypeName(filter));
     // log::debug("hash {} threadid {}", BaseFilterHash{}(filter), std::this_thread::get_id());
+    m_impl->processRemovals();
 
     auto it = m_impl->m_ports.find(filter);
-
-    // if (std::string(cast::getRuntimeTypeName(filter)).find("UpdateModListStateEvent") != std::string::npos) {
-    // if (it == m_impl->m_ports.end()) {
-    //     log::debug("in ports, not found");
-    // }
-    // else {
-    //     log::debug("in ports, found {} -> {}, ({})", (void*)it->first.get(), (void*)it->second.get(), cast::getRuntimeTypeName(it->first.get()));
-    // }}
-
     if (it != m_impl->m_ports.end()) {
-        if (auto newPort = std::invoke(migratePort, it->second.get())) {
-            it->second.reset(newPort);
-        }
-        return ListenerHandle(it->first, std::invoke(func, it->second.get()), nullptr);
+        return ListenerHandle(it->first, std::invoke(func, it->second.ensureVersion(migratePort, version, m_impl->m_generation)), nullptr);
     }
     else {
-        auto clonedFilter = Impl::KeyType(filter->clone());
-        // if (std::string(cast::getRuntimeTypeName(filter)).find("UpdateModListStateEvent") != std::string::npos) {
-        // log::debug("cloned filter {}, typename {}", (void*)clonedFilter.get(), cast::getRuntimeTypeName(clonedFilter.get()));
-        // }
+        auto clonedFilter = std::shared_ptr<BaseFilter>(filter->clone());
         if (!clonedFilter) return ListenerHandle();
-        auto filter2 = clonedFilter.get();
-        // geode::console::log(fmt::format("Cloned filter for adding receiver {}, {}", (void*)filter2, cast::getRuntimeTypeName(filter2)), Severity::Debug);
 
-        auto port = Impl::ValueType(clonedFilter->getPort());
+        // the port is created by the caller's own filter, so it already is the caller's version
+        auto port = std::shared_ptr<OpaquePortBase>(clonedFilter->getPort());
         if (!port) return ListenerHandle();
 
         ReceiverHandle handle = std::invoke(func, port.get());
-        // if (std::string(cast::getRuntimeTypeName(filter)).find("UpdateModListStateEvent") != std::string::npos) {
-        // log::debug("handle {}", handle);
-        // }
         auto ret = ListenerHandle(clonedFilter, handle, nullptr);
 
-        m_impl->m_ports.emplace(std::move(clonedFilter), std::move(port));
-
-        auto it2 = m_impl->m_ports.find(filter);
-    //     if (std::string(cast::getRuntimeTypeName(filter)).find("UpdateModListStateEvent") != std::string::npos) {
-    //     if (it2 == m_impl->m_ports.end()) {
-    //         log::debug("added into ports, not found");
-    //     }
-    //     else {
-    //         log::debug("added into ports, found {} -> {}", (void*)it2->first.get(), (void*)it2->second.get());
-    //     }
-    // }
+        m_impl->registerPort(clonedFilter);
+        m_impl->m_ports.emplace(std::move(clonedFilter), PortEntry{std::move(port), version});
+        m_impl->m_generation.store(nextGeneration(), std::memory_order_release);
         return ret;
     }
 }
-size_t EventCenterThreadLocal::getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort) noexcept {
+size_t EventCenterThreadLocal::getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept {
+    m_impl->processRemovals();
+
     auto it = m_impl->m_ports.find(filter);
     if (it != m_impl->m_ports.end()) {
-        if (auto newPort = std::invoke(migratePort, it->second.get())) {
-            it->second.reset(newPort);
-        }
-        return std::invoke(func, it->second.get());
+        return std::invoke(func, it->second.ensureVersion(migratePort, version, m_impl->m_generation));
     }
     return 0;
 }
-size_t EventCenterThreadLocal::removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort) noexcept {
+size_t EventCenterThreadLocal::removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept {
     // log::debug("EventCenterThreadLocal removing receiver for filter {}, {}", (void*)filter, cast::getRuntimeTypeName(filter));
     // log::debug("hash {} threadid {}", BaseFilterHash{}(filter), std::this_thread::get_id());
+    m_impl->processRemovals();
 
     auto it = m_impl->m_ports.find(filter);
-    if (it != m_impl->m_ports.end()) {
-        if (auto newPort = std::invoke(migratePort, it->second.get())) {
-            it->second.reset(newPort);
-        }
-        auto size = std::invoke(func, it->second.get());
-        if (size == 0) {
-            // geode::console::log(fmt::format("Removing port for filter type {}", cast::getRuntimeTypeName(filter)), Severity::Debug);
-            m_impl->m_ports.erase(it);
+    if (!m_impl->m_perThread) {
+        if (it != m_impl->m_ports.end()) {
+            return m_impl->removeFrom(it, func, migratePort, version);
         }
+        return (size_t)-1;
+    }
 
-        // if (std::string(cast::getRuntimeTypeName(filter)).find("UpdateModListStateEvent") != std::string::npos) {
-        //     log::debug("port size {}", size);
-        // }
-        return size;
+    // Removals come from listener handles, which pass the exact filter key
+    // of the port they were registered on. If that key doesn't live in this
+    // thread's center, the listener belongs to another thread.
+    if (it != m_impl->m_ports.end() && it->first.get() == filter) {
+        return m_impl->removeFrom(it, func, migratePort, version);
     }
+    Impl::deferRemoval(filter, func, migratePort, version);
     return (size_t)-1;
 }
 
+std::shared_ptr<OpaquePortBase> EventCenterThreadLocal::resolvePort(BaseFilter const* filter, MigrateFuncType migratePort, PortVersion version) noexcept {
+    m_impl->processRemovals();
+
+    auto it = m_impl->m_ports.find(filter);
+    if (it != m_impl->m_ports.end()) {
+        it->second.ensureVersion(migratePort, version, m_impl->m_generation);
+        return it->second.port;
+    }
+    return nullptr;
+}
+size_t EventCenterThreadLocal::getGeneration() const noexcept {
+    return m_impl->m_generation.load(std::memory_order_acquire);
+}
+
+// ConcurrentPortMap
+
+namespace {
+    // Concurrent filter -> port map. Entries are spread over shards by filter
+    // hash; lookups are lock-free, while registration and removal take the
+    // lock of their shard only, so adding a new filter is O(1) amortized
+    // instead of copying the whole map.
+    class ConcurrentPortMap {
+    public:
+        using MigrateFuncType = EventCenterGlobal::MigrateFuncType;
+
+        struct Entry {
+            std::shared_ptr<BaseFilter> filter;
+            std::shared_ptr<OpaquePortBase> port;
+        };
+
+    private:
+        static constexpr size_t SHARD_COUNT = 16;
+
+        struct Node {
+            size_t hash;
+            std::shared_ptr<BaseFilter> filter;
+            std::shared_ptr<OpaquePortBase> port;
+            std::atomic<PortVersion> version;
+            std::atomic<Node*> next = nullptr;
+
+            Node(size_t hash, std::shared_ptr<BaseFilter> filter, std::shared_ptr<OpaquePortBase> port, PortVersion version)
+              : hash(hash), filter(std::move(filter)), port(std::move(port)), version(version) {}
+        };
+
+        struct Table {
+            size_t size;
+            std::unique_ptr<std::atomic<Node*>[]> buckets;
+
+            explicit Table(size_t size) : size(size), buckets(new std::atomic<Node*>[size]) {
+                for (size_t i = 0; i < size; ++i) {
+                    buckets[i].store(nullptr, std::memory_order_relaxed);
+                }
+            }
+
+            std::atomic<Node*>& bucket(size_t hash) {
+                return buckets[hash & (size - 1)];
+            }
+        };
+
+        // Readers never lock; they only count themselves in the reader slot of
+        // the current epoch while walking the shard. Writers hold the shard
+        // mutex, and free what they unlinked right after moving the epoch on
+        // and waiting for the slot of the previous epoch to empty, as readers
+        // arriving in the new epoch can no longer reach it. Readers only stay
+        // for one chain walk, so the wait is short and nothing piles up.
+        struct Shard {
+            std::mutex m_mutex;
+            std::atomic<Table*> m_table = new Table(8);
+            std::atomic_size_t m_epoch = 0;
+            std::array<std::atomic_size_t, 2> m_readers {};
+            size_t m_count = 0;
+            std::vector<Node*> m_retiredNodes;
+            std::vector<Table*> m_retiredTables;
+
+            ~Shard() {
+                this->reclaim();
+                auto table = m_table.load(std::memory_order_relaxed);
+                for (size_t i = 0; i < table->size; ++i) {
+                    auto node = table->buckets[i].load(std::memory_order_relaxed);
+                    while (node) {
+                        auto next = node->next.load(std::memory_order_relaxed);
+                        delete node;
+                        node = next;
+                    }
+                }
+                delete table;
+            }
+
+            Node* findNode(BaseFilter const* filter, size_t hash) {
+                auto table = m_table.load(std::memory_order_acquire);
+                auto node = table->bucket(hash).load(std::memory_order_acquire);
+                while (node) {
+                    if (node->hash == hash && *filter == *node->filter) {
+                        return node;
+                    }
+                    node = node->next.load(std::memory_order_acquire);
+                }
+                return nullptr;
+            }
+
+            std::atomic<Node*>& linkTo(Node* node) {
+                auto link = &m_table.load(std::memory_order_relaxed)->bucket(node->hash);
+                while (link->load(std::memory_order_relaxed) != node) {
+                    link = &link->load(std::memory_order_relaxed)->next;
+                }
+                return *link;
+            }
+
+            void insert(Node* node) {
+                auto& head = m_table.load(std::memory_order_relaxed)->bucket(node->hash);
+                node->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                head.store(node, std::memory_order_release);
+                if (++m_count > m_table.load(std::memory_order_relaxed)->size) {
+                    this->grow();
+                }
+            }
+
+            void replace(Node* node, Node* replacement) {
+                replacement->next.store(node->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                this->linkTo(node).store(replacement, std::memory_order_release);
+                m_retiredNodes.push_back(node);
+            }
+
+            void unlink(Node* node) {
+                this->linkTo(node).store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+                m_retiredNodes.push_back(node);
+                m_count -= 1;
+            }
+
+            // Readers may be walking the old chains, so they can't be relinked
+            // in place; the nodes are copied into a new table instead
+            void grow() {
+                auto old = m_table.load(std::memory_order_relaxed);
+                auto table = new Table(old->size * 2);
+                for (size_t i = 0; i < old->size; ++i) {
+                    auto node = old->buckets[i].load(std::memory_order_relaxed);
+                    while (node) {
+                        auto copy = new Node(node->hash, node->filter, node->port, node->version.load(std::memory_order_relaxed));
+                        auto& head = table->bucket(copy->hash);
+                        copy->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                        head.store(copy, std::memory_order_relaxed);
+                        m_retiredNodes.push_back(node);
+                        node = node->next.load(std::memory_order_relaxed);
+                    }
+                }
+                m_table.store(table, std::memory_order_release);
+                m_retiredTables.push_back(old);
+            }
+
+            // Must be called with the shard locked
+            void reclaim() {
+                if (m_retiredNodes.empty() && m_retiredTables.empty()) return;
+
+                // Readers of the previous epoch may still see the retired
+                // items, readers of the next one can't
+                auto epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst);
+                auto& readers = m_readers[epoch & 1];
+                while (readers.load(std::memory_order_seq_cst) != 0) {
+                    std::this_thread::yield();
+                }
+
+                for (auto node : m_retiredNodes) delete node;
+                for (auto table : m_retiredTables) delete table;
+                m_retiredNodes.clear();
+                m_retiredTables.clear();
+            }
+        };
+
+        struct ReadGuard {
+            std::atomic_size_t* readers;
+            ReadGuard(Shard& shard) {
+                while (true) {
+                    auto epoch = shard.m_epoch.load(std::memory_order_seq_cst);
+                    readers = &shard.m_readers[epoch & 1];
+                    readers->fetch_add(1, std::memory_order_seq_cst);
+                    // if the epoch moved on in between, the writer may
+                    // already be past waiting for this slot
+                    if (shard.m_epoch.load(std::memory_order_seq_cst) == epoch) break;
+                    readers->fetch_sub(1, std::memory_order_release);
+                }
+            }
+            ~ReadGuard() {
+                readers->fetch_sub(1, std::memory_order_release);
+            }
+        };
+
+        std::array<Shard, SHARD_COUNT> m_shards;
+        std::atomic_size_t m_generation = 1;
+
+        Shard& shardFor(size_t hash) {
+            // the low bits of the hash pick the bucket
+            return m_shards[(hash >> 16) % SHARD_COUNT];
+        }
+
+        // Must be called with the shard locked
+        Node* checkVersion(Shard& shard, Node* node, MigrateFuncType& migratePort, PortVersion version) {
+            auto current = node->version.load(std::memory_order_relaxed);
+            if (version != 0 && current >= version) {
+                return node;
+            }
+            if (auto newPort = std::invoke(migratePort, node->port.get())) {
+                auto replacement = new Node(node->hash, node->filter, std::shared_ptr<OpaquePortBase>(newPort), std::max(current, version));
+                shard.replace(node, replacement);
+                // senders bound to the old port need to look it up again
+                m_generation.fetch_add(1, std::memory_order_release);
+                return replacement;
+            }
+            node->version.store(std::max(current, version), std::memory_order_release);
+            return node;
+        }
+
+    public:
+        // Lock-free lookup, unless the port still has to be checked against version
+        Entry find(BaseFilter const* filter, MigrateFuncType& migratePort, PortVersion version) noexcept {
+            auto hash = filter->hash();
+            auto& shard = this->shardFor(hash);
+            {
+                ReadGuard guard(shard);
+                auto node = shard.findNode(filter, hash);
+                if (!node) {
+                    return {};
+                }
+                if (version != 0 && node->version.load(std::memory_order_acquire) >= version) {
+                    return { node->filter, node->port };
+                }
+            }
+
+            // the port hasn't been checked against this version yet
+            std::lock_guard lock(shard.m_mutex);
+            auto node = shard.findNode(filter, hash);
+            if (!node) {
+                return {};
+            }
+            node = this->checkVersion(shard, node, migratePort, version);
+            Entry ret { node->filter, node->port };
+            shard.reclaim();
+            return ret;
+        }
+
+        // Finds the port for a filter, creating it if needed, and calls func on it
+        // while holding the shard lock. Returns an empty entry if creation failed
+        Entry findOrCreate(
+            BaseFilter const* filter, MigrateFuncType& migratePort, PortVersion version,
+            geode::FunctionRef<void(OpaquePortBase*)> func
+        ) noexcept {
+            auto hash = filter->hash();
+            auto& shard = this->shardFor(hash);
+
+            std::lock_guard lock(shard.m_mutex);
+            if (auto node = shard.findNode(filter, hash)) {
+                node = this->checkVersion(shard, node, migratePort, version);
+                func(node->port.get());
+                Entry ret { node->filter, node->port };
+                shard.reclaim();
+                return ret;
+            }
+
+            auto clonedFilter = std::shared_ptr<BaseFilter>(filter->clone());
+            if (!clonedFilter) return {};
+
+            // the port is created by the caller's own filter, so it already is the caller's version
+            auto port = std::shared_ptr<OpaquePortBase>(clonedFilter->getPort());
+            if (!port) return {};
+
+            func(port.get());
+            shard.insert(new Node(hash, clonedFilter, port, version));
+            m_generation.fetch_add(1, std::memory_order_release);
+            shard.reclaim();
+            return { std::move(clonedFilter), std::move(port) };
+        }
+
+        // Calls func on the port for a filter while holding the shard lock, and
+        // removes the port if func returns 0. Returns nullopt if there is no port
+        std::optional<size_t> update(
+            BaseFilter const* filter, MigrateFuncType& migratePort, PortVersion version,
+            geode::FunctionRef<size_t(OpaquePortBase*)> func
+        ) noexcept {
+            auto hash = filter->hash();
+            auto& shard = this->shardFor(hash);
+
+            std::lock_guard lock(shard.m_mutex);
+            auto node = shard.findNode(filter, hash);
+            if (!node) {
+                return std::nullopt;
+            }
+            node = this->checkVersion(shard, node, migratePort, version);
+            auto size = func(node->port.get());
+            if (size == 0) {
+                // geode::console::log(fmt::format("Removing port for filter type {}", cast::getRuntimeTypeName(filter)), Severity::Debug);
+                shard.unlink(node);
+            }
+            shard.reclaim();
+            return size;
+        }
+
+        // Changes every time a port is added or replaced
+        size_t getGeneration() const noexcept {
+            return m_generation.load(std::memory_order_acquire);
+        }
+    };
+}
+
 // EventCenterGlobal
 
 class EventCenterGlobal::Impl {
 public:
-    using KeyType = std::shared_ptr<BaseFilter>;
-    using ValueType = std::shared_ptr<OpaquePortBase>;
-    using MapType = std::unordered_map<KeyType, ValueType, BaseFilterHash, BaseFilterEqual>;
-
-    std::mutex m_mutex;
-    MapType m_ports;
+    ConcurrentPortMap m_ports;
 };
 
 EventCenterGlobal::EventCenterGlobal() : m_impl(std::make_unique<Impl>()) {}
@@ -145,81 +645,109 @@ EventCenterGlobal* EventCenterGlobal::get() {
 }
 
 bool EventCenterGlobal::send(BaseFilter const* filter, SendFuncType func, MigrateFuncType migratePort) noexcept {
-    // log::debug("EventCenterGlobal sending event for filter {}, {}", (void*)filter, cast::getRuntimeTypeName(filter));
-
-    auto lock = std::unique_lock<std::mutex>(m_impl->m_mutex);
-    auto it = m_impl->m_ports.find(filter);
-    auto const end = m_impl->m_ports.end();
-    lock.unlock();
+    return this->send(filter, std::move(func), std::move(migratePort), 0);
+}
+ListenerHandle EventCenterGlobal::addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort) noexcept {
+    return this->addReceiver(filter, std::move(func), std::move(migratePort), 0);
+}
+size_t EventCenterGlobal::getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort) noexcept {
+    return this->getReceiverCount(filter, std::move(func), std::move(migratePort), 0);
+}
+size_t EventCenterGlobal::removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort) noexcept {
+    return this->removeReceiver(filter, std::move(func), std::move(migratePort), 0);
+}
 
-    if (it != end) {
-        if (auto newPort = std::invoke(migratePort, it->second.get())) {
-            it->second.reset(newPort);
-        }
-        return std::invoke(func, it->second.get());
+bool EventCenterGlobal::send(BaseFilter const* filter, SendFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept {
+    GEODE_PROFILE_ZONE("Event send");
+    // log::debug("EventCenterGlobal sending event for filter {}, {}", (void*)filter, cast::getRuntimeTypeName(filter));
+    auto entry = m_impl->m_ports.find(filter, migratePort, version);
+    if (entry.port) {
+        return std::invoke(func, entry.port.get());
     }
     return false;
 }
-ListenerHandle EventCenterGlobal::addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort) noexcept {
+ListenerHandle EventCenterGlobal::addReceiver(BaseFilter const* filter, AddFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept {
     // log::debug("EventCenterGlobal adding receiver for filter {}, {}", (void*)filter, cast::getRuntimeTypeName(filter));
+    ReceiverHandle handle = {};
+    auto entry = m_impl->m_ports.findOrCreate(filter, migratePort, version, [&](OpaquePortBase* port) {
+        handle = std::invoke(func, port);
+    });
+    if (!entry.filter) return ListenerHandle();
+    return ListenerHandle(std::move(entry.filter), handle, nullptr);
+}
+size_t EventCenterGlobal::getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept {
+    auto entry = m_impl->m_ports.find(filter, migratePort, version);
+    if (entry.port) {
+        return std::invoke(func, entry.port.get());
+    }
+    return 0;
+}
+size_t EventCenterGlobal::removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort, PortVersion version) noexcept {
+    // log::debug("EventCenterGlobal removing receiver for filter {}, {}", (void*)filter, cast::getRuntimeTypeName(filter));
+    auto size = m_impl->m_ports.update(filter, migratePort, version, [&](OpaquePortBase* port) -> size_t {
+        return std::invoke(func, port);
+    });
+    return size.value_or((size_t)-1);
+}
 
-    auto lock = std::unique_lock<std::mutex>(m_impl->m_mutex);
-    auto it = m_impl->m_ports.find(filter);
-    auto const end = m_impl->m_ports.end();
+std::shared_ptr<OpaquePortBase> EventCenterGlobal::resolvePort(BaseFilter const* filter, MigrateFuncType migratePort, PortVersion version) noexcept {
+    return m_impl->m_ports.find(filter, migratePort, version).port;
+}
+size_t EventCenterGlobal::getGeneration() const noexcept {
+    return m_impl->m_ports.getGeneration();
+}
 
-    if (it != end) {
-        if (auto newPort = std::invoke(migratePort, it->second.get())) {
-            it->second.reset(newPort);
+// Receiver owners
+
+namespace {
+    struct ReceiverOwners {
+        std::mutex mutex;
+        std::unordered_map<void const*, std::unordered_map<ReceiverHandle, Mod*>> ports;
+
+        static ReceiverOwners& get() {
+            static auto s_instance = new ReceiverOwners();
+            return *s_instance;
         }
-        return ListenerHandle(it->first, std::invoke(func, it->second.get()), nullptr);
-    }
-    else {
-        auto clonedFilter = Impl::KeyType(filter->clone());
-        if (!clonedFilter) return ListenerHandle();
-        auto filter2 = clonedFilter.get();
-        // geode::console::log(fmt::format("Cloned filter for adding receiver {}, {}", (void*)filter2, cast::getRuntimeTypeName(filter2)), Severity::Debug);
+    };
+}
 
-        auto port = Impl::ValueType(clonedFilter->getPort());
-        if (!port) return ListenerHandle();
+std::atomic_bool comm::detail::hasReceiverOwners = false;
 
-        ReceiverHandle handle = std::invoke(func, port.get());
-        auto ret = ListenerHandle(clonedFilter, handle, nullptr);
+void comm::setReceiverOwner(void const* port, ReceiverHandle handle, Mod* owner) noexcept {
+    detail::hasReceiverOwners.store(true, std::memory_order_relaxed);
+    auto& owners = ReceiverOwners::get();
+    std::lock_guard lock(owners.mutex);
+    owners.ports[port].insert_or_assign(handle, owner);
+}
 
-        m_impl->m_ports.emplace(std::move(clonedFilter), std::move(port));
-        return ret;
+void comm::removeReceiverOwner(void const* port, ReceiverHandle handle) noexcept {
+    auto& owners = ReceiverOwners::get();
+    std::lock_guard lock(owners.mutex);
+    auto it = owners.ports.find(port);
+    if (it == owners.ports.end()) return;
+    it->second.erase(handle);
+    if (it->second.empty()) {
+        owners.ports.erase(it);
     }
 }
-size_t EventCenterGlobal::getReceiverCount(BaseFilter const* filter, SizeFuncType func, MigrateFuncType migratePort) noexcept {
-    auto lock = std::unique_lock<std::mutex>(m_impl->m_mutex);
-    auto it = m_impl->m_ports.find(filter);
-    auto const end = m_impl->m_ports.end();
-    lock.unlock();
-    
-    if (it != end) {
-        if (auto newPort = std::invoke(migratePort, it->second.get())) {
-            it->second.reset(newPort);
-        }
-        return std::invoke(func, it->second.get());
+
+void comm::moveReceiverOwners(void const* from, void const* to) noexcept {
+    auto& owners = ReceiverOwners::get();
+    std::lock_guard lock(owners.mutex);
+    auto it = owners.ports.find(from);
+    if (it == owners.ports.end()) return;
+    auto moved = std::move(it->second);
+    owners.ports.erase(it);
+    if (to) {
+        owners.ports[to].merge(moved);
     }
-    return 0;
 }
-size_t EventCenterGlobal::removeReceiver(BaseFilter const* filter, RemoveFuncType func, MigrateFuncType migratePort) noexcept {
-    // log::debug("EventCenterGlobal removing receiver for filter {}, {}", (void*)filter, cast::getRuntimeTypeName(filter));
-
-    auto lock = std::unique_lock<std::mutex>(m_impl->m_mutex);
-    auto it = m_impl->m_ports.find(filter);
-    auto const end = m_impl->m_ports.end();
 
-    if (it != end) {
-        if (auto newPort = std::invoke(migratePort, it->second.get())) {
-            it->second.reset(newPort);
-        }
-        auto size = std::invoke(func, it->second.get());
-        if (size == 0) {
-            // geode::console::log(fmt::format("Removing port for filter type {}", cast::getRuntimeTypeName(filter)), Severity::Debug);
-            m_impl->m_ports.erase(it);
-        }
-        return size;
-    }
-    return (size_t)-1;
-}
\ No newline at end of file
+Mod* comm::getReceiverOwner(void const* port, ReceiverHandle handle) noexcept {
+    auto& owners = ReceiverOwners::get();
+    std::lock_guard lock(owners.mutex);
+    auto it = owners.ports.find(port);
+    if (it == owners.ports.end()) return nullptr;
+    auto owner = it->second.find(handle);
+    return owner != it->second.end() ? owner->second : nullptr;
+}
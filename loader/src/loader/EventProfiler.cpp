@@ -0,0 +1,215 @@
+#include <Geode/loader/EventProfiler.hpp>
+
+#ifdef GEODE_EVENT_PROFILER
+
+#include <Geode/loader/Mod.hpp>
+#include <Geode/utils/hash.hpp>
+#include <matjson.hpp>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#ifndef GEODE_IS_WINDOWS
+#include <cxxabi.h>
+#endif
+
+using namespace geode::prelude;
+using namespace geode::comm;
+
+namespace {
+    struct EventData {
+        size_t sends = 0;
+        size_t receiversInvoked = 0;
+        std::chrono::nanoseconds totalTime{0};
+    };
+
+    struct ReceiverData {
+        size_t calls = 0;
+        std::chrono::nanoseconds totalTime{0};
+        std::chrono::nanoseconds maxTime{0};
+    };
+
+    struct ReceiverKey {
+        char const* eventType;
+        Mod* mod;
+
+        bool operator==(ReceiverKey const&) const = default;
+    };
+
+    struct ReceiverKeyHash {
+        size_t operator()(ReceiverKey const& key) const noexcept {
+            auto seed = std::hash<char const*>()(key.eventType);
+            hashCombine(seed, key.mod);
+            return seed;
+        }
+    };
+
+    // Keyed by the raw type name pointer, which is cheap to hash. Different
+    // binaries may have their own copy of the same name, those are merged
+    // when taking a snapshot
+    struct Profiler {
+        std::atomic_bool enabled = true;
+        std::mutex mutex;
+        std::unordered_map<char const*, EventData> events;
+        std::unordered_map<ReceiverKey, ReceiverData, ReceiverKeyHash> receivers;
+
+        static Profiler& get() {
+            static auto s_instance = new Profiler();
+            return *s_instance;
+        }
+    };
+
+    std::string demangle(char const* name) {
+        if (!name) return "<unknown>";
+    #ifdef GEODE_IS_WINDOWS
+        std::string_view tname = name;
+        if (tname.starts_with("class ")) {
+            tname.remove_prefix(6);
+        } else if (tname.starts_with("struct ")) {
+            tname.remove_prefix(7);
+        }
+        return std::string(tname);
+    #else
+        std::string ret = name;
+        int status = 0;
+        auto demangled = abi::__cxa_demangle(name, 0, 0, &status);
+        if (status == 0) {
+            ret = demangled;
+        }
+        free(demangled);
+        return ret;
+    #endif
+    }
+}
+
+void profiler::setEnabled(bool enabled) noexcept {
+    Profiler::get().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool profiler::isEnabled() noexcept {
+    return Profiler::get().enabled.load(std::memory_order_relaxed);
+}
+
+char const*& profiler::currentEvent() noexcept {
+    static thread_local char const* s_current = nullptr;
+    return s_current;
+}
+
+void profiler::recordSend(char const* eventType) noexcept {
+    auto& p = Profiler::get();
+    if (!p.enabled.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard lock(p.mutex);
+    p.events[eventType].sends += 1;
+}
+
+void profiler::recordReceiver(char const* eventType, Mod* mod, std::chrono::nanoseconds time) noexcept {
+    auto& p = Profiler::get();
+    if (!p.enabled.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard lock(p.mutex);
+    auto& event = p.events[eventType];
+    event.receiversInvoked += 1;
+    event.totalTime += time;
+
+    auto& receiver = p.receivers[ReceiverKey{eventType, mod}];
+    receiver.calls += 1;
+    receiver.totalTime += time;
+    receiver.maxTime = std::max(receiver.maxTime, time);
+}
+
+profiler::Snapshot profiler::snapshot() {
+    auto& p = Profiler::get();
+    std::unordered_map<char const*, EventData> events;
+    std::unordered_map<ReceiverKey, ReceiverData, ReceiverKeyHash> receivers;
+    {
+        std::lock_guard lock(p.mutex);
+        events = p.events;
+        receivers = p.receivers;
+    }
+
+    // demangling is slow, so only do it once per name pointer
+    std::unordered_map<char const*, std::string> names;
+    auto nameOf = [&](char const* type) -> std::string const& {
+        auto it = names.find(type);
+        if (it == names.end()) {
+            it = names.emplace(type, demangle(type)).first;
+        }
+        return it->second;
+    };
+
+    std::unordered_map<std::string, EventStats> mergedEvents;
+    for (auto& [type, data] : events) {
+        auto& name = nameOf(type);
+        auto& stats = mergedEvents[name];
+        stats.eventType = name;
+        stats.sends += data.sends;
+        stats.receiversInvoked += data.receiversInvoked;
+        stats.totalTime += data.totalTime;
+    }
+
+    std::map<std::pair<std::string, Mod*>, ReceiverStats> mergedReceivers;
+    for (auto& [key, data] : receivers) {
+        auto& name = nameOf(key.eventType);
+        auto& stats = mergedReceivers[{name, key.mod}];
+        stats.eventType = name;
+        stats.mod = key.mod;
+        stats.calls += data.calls;
+        stats.totalTime += data.totalTime;
+        stats.maxTime = std::max(stats.maxTime, data.maxTime);
+    }
+
+    Snapshot ret;
+    for (auto& [_, stats] : mergedEvents) {
+        ret.events.push_back(std::move(stats));
+    }
+    for (auto& [_, stats] : mergedReceivers) {
+        ret.receivers.push_back(std::move(stats));
+    }
+    std::sort(ret.events.begin(), ret.events.end(), [](auto const& a, auto const& b) {
+        return a.totalTime > b.totalTime;
+    });
+    std::sort(ret.receivers.begin(), ret.receivers.end(), [](auto const& a, auto const& b) {
+        return a.totalTime > b.totalTime;
+    });
+    return ret;
+}
+
+void profiler::reset() {
+    auto& p = Profiler::get();
+    std::lock_guard lock(p.mutex);
+    p.events.clear();
+    p.receivers.clear();
+}
+
+std::string profiler::exportJSON(Snapshot const& snapshot) {
+    auto events = matjson::Value::array();
+    for (auto& stats : snapshot.events) {
+        auto obj = matjson::Value::object();
+        obj["event"] = stats.eventType;
+        obj["sends"] = stats.sends;
+        obj["receivers-invoked"] = stats.receiversInvoked;
+        obj["total-ns"] = stats.totalTime.count();
+        events.push(std::move(obj));
+    }
+
+    auto receivers = matjson::Value::array();
+    for (auto& stats : snapshot.receivers) {
+        auto obj = matjson::Value::object();
+        obj["event"] = stats.eventType;
+        obj["mod"] = stats.mod ? matjson::Value(std::string(stats.mod->getID().view())) : matjson::Value();
+        obj["calls"] = stats.calls;
+        obj["total-ns"] = stats.totalTime.count();
+        obj["max-ns"] = stats.maxTime.count();
+        receivers.push(std::move(obj));
+    }
+
+    auto json = matjson::Value::object();
+    json["events"] = std::move(events);
+    json["receivers"] = std::move(receivers);
+    return json.dump();
+}
+
+#endif
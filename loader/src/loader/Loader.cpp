@@ -79,6 +79,26 @@ void Loader::queueInMainThread(ScheduledFunction&& func) {
     return m_impl->queueInMainThread(std::forward<ScheduledFunction>(func));
 }
 
+void Loader::queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority, Mod* owner) {
+    return m_impl->queueInMainThread(std::forward<ScheduledFunction>(func), priority, owner);
+}
+
+void Loader::queueInMainThreadCoalesced(std::string key, ScheduledFunction&& func, MainThreadPriority priority, Mod* owner) {
+    return m_impl->queueInMainThreadCoalesced(std::move(key), std::forward<ScheduledFunction>(func), priority, owner);
+}
+
+void Loader::setMainThreadBudget(std::chrono::microseconds budget) {
+    return m_impl->setMainThreadBudget(budget);
+}
+
+std::chrono::microseconds Loader::getMainThreadBudget() const {
+    return m_impl->getMainThreadBudget();
+}
+
+MainThreadQueueStats Loader::getMainThreadQueueStats() const {
+    return m_impl->getMainThreadQueueStats();
+}
+
 std::string Loader::getGameVersion() {
     return m_impl->getGameVersion();
 }
@@ -4,6 +4,7 @@
 #include "ModImpl.hpp"
 #include "ModMetadataImpl.hpp"
 #include "LogImpl.hpp"
+#include "StartupTimelineImpl.hpp"
 #include "console.hpp"
 
 #include <Geode/loader/Event.hpp>
@@ -12,18 +13,23 @@
 #include <Geode/loader/Loader.hpp>
 #include <Geode/loader/Log.hpp>
 #include <Geode/loader/Mod.hpp>
+#include <Geode/loader/Watchdog.hpp>
 #include <Geode/utils/JsonValidation.hpp>
+#include <Geode/utils/async.hpp>
 #include <Geode/utils/file.hpp>
 #include <Geode/utils/map.hpp>
 #include <Geode/utils/ranges.hpp>
 #include <Geode/utils/string.hpp>
+#include <Geode/utils/timer.hpp>
 #include <Geode/utils/web.hpp>
 #include <about.hpp>
+#include <algorithm>
 #include <crashlog.hpp>
 #include <fmt/format.h>
 #include <hash.hpp>
 #include <iostream>
 #include <iterator>
+#include <latch>
 #include <optional>
 #include <resources.hpp>
 #include <string>
@@ -82,11 +88,7 @@ Result<> Loader::Impl::setup() {
         return Ok();
     }
 
-    if (this->supportsLaunchArguments()) {
-        log::info("Loading launch arguments");
-        log::NestScope nest;
-        this->initLaunchArguments();
-    }
+    this->setupLaunchArguments();
 
     if (auto value = this->getLaunchArgument("use-common-handler-offset")) {
         log::info("Using common handler offset: {}", value.value());
@@ -106,6 +108,46 @@ Result<> Loader::Impl::setup() {
         }
     }
 
+    if (auto value = this->getLaunchArgument("main-thread-budget")) {
+        if (auto ms = numFromString<double>(value.value())) {
+            log::info("Using main thread budget of {}ms", ms.unwrap());
+            this->setMainThreadBudget(std::chrono::microseconds(static_cast<int64_t>(ms.unwrap() * 1000)));
+        } else {
+            log::error("Could not parse main thread budget, falling back to default");
+        }
+    }
+
+    if (auto value = this->getLaunchArgument("mod-load-budget")) {
+        if (auto ms = numFromString<double>(value.value())) {
+            log::info("Using mod load budget of {}ms", ms.unwrap());
+            m_modLoadBudget = std::chrono::microseconds(static_cast<int64_t>(ms.unwrap() * 1000));
+        } else {
+            log::error("Could not parse mod load budget, falling back to default");
+        }
+    }
+
+    if (auto value = this->getLaunchArgument("loader-fan-out")) {
+        if (auto count = numFromString<size_t>(value.value()); count && count.unwrap() > 0) {
+            log::info("Fanning loading out over {} jobs", count.unwrap());
+            m_fanOutWidth = count.unwrap();
+        } else {
+            log::error("Could not parse loader fan-out, falling back to default");
+        }
+    }
+
+    if (this->getLaunchFlag("hitch-watchdog")) {
+        log::info("Enabling hitch watchdog");
+        watchdog::setEnabled(true);
+    }
+
+    if (auto value = this->getLaunchArgument("hitch-threshold")) {
+        if (auto ms = numFromString<int64_t>(value.value())) {
+            watchdog::setThreshold(std::chrono::milliseconds(ms.unwrap()));
+        } else {
+            log::error("Could not parse hitch threshold, falling back to default");
+        }
+    }
+
     if (auto value = this->getLaunchArgument("binary-dir")) {
         log::info("Using custom binary directory: {}", value.value());
         m_binaryPath = value.value();
@@ -144,7 +186,10 @@ Result<> Loader::Impl::setup() {
 
     // Trigger on_mod(Loaded) for the internal mod
     // this function is already on the gd thread, so this should be fine
-    ModStateEvent(ModEventType::Loaded, Mod::get()).send();
+    {
+        startup::ScopedSpan span(startup::Phase::LoadedHandlers, Mod::get()->getID().view());
+        ModStateEvent(ModEventType::Loaded, Mod::get()).send();
+    }
 
     log::info("Refreshing mod graph");
     this->refreshModGraph();
@@ -173,6 +218,12 @@ void Loader::Impl::updateResources(bool forceReload) {
     // we have to call it in both places since setup is only called once ever, but updateResources is called
     // on every texture reload
     CCFileUtils::get()->updatePaths();
+
+    // the first time resources get added after the mods are done loading
+    // is the last step of startup
+    if (m_loadingState == LoadingState::Done) {
+        startup::finish();
+    }
 }
 
 std::vector<Mod*> Loader::Impl::getAllMods() {
@@ -252,6 +303,8 @@ Mod* Loader::Impl::getLoadedMod(std::string_view id) const {
 }
 
 void Loader::Impl::updateModResources(Mod* mod) {
+    startup::ScopedSpan span(startup::Phase::UpdateResources, mod->getID().view());
+
     if (!mod->isInternal()) {
         // geode.loader resource is stored somewhere else, which is already added anyway
         auto searchPathRoot = dirs::getModRuntimeDir() / mod->getID() / "resources";
@@ -314,42 +367,113 @@ void Loader::Impl::addProblem(LoadProblem const& problem) {
 // Dependencies and refreshing
 
 void Loader::Impl::queueMods(std::vector<ModMetadata>& modQueue) {
+    startup::ScopedSpan span(startup::Phase::QueueMods);
+
+    // Finding the packages is cheap, opening and parsing them isn't, so
+    // collect them all first and then parse them in parallel
+    std::vector<std::filesystem::path> packages;
     for (auto const& dir : m_modSearchDirectories) {
         log::debug("Searching {}", dir);
-        log::NestScope nest;
+        auto first = packages.size();
         for (auto const& entry : std::filesystem::directory_iterator(dir)) {
             if (!std::filesystem::is_regular_file(entry) ||
                 entry.path().extension() != GEODE_MOD_EXTENSION)
                 continue;
+            packages.push_back(entry.path());
+        }
+        // directory order is up to the filesystem, sorting makes which of
+        // two duplicates wins the same on every launch
+        std::sort(packages.begin() + first, packages.end());
+    }
+
+    // packages that haven't changed since last launch don't need opening
+    ModMetadataIndex index;
+    std::vector<ModMetadata> parsed(packages.size());
+    std::atomic_size_t next = 0;
+    auto parse = [&] {
+        while (true) {
+            auto i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= packages.size()) break;
+            startup::ScopedSpan parseSpan(startup::Phase::ParseMetadata, utils::string::pathToString(packages[i].filename()));
+            // nothing may escape this, the helpers share the locals here
+            try {
+                parsed[i] = index.get(packages[i]);
+            }
+            catch (std::exception const& e) {
+                parsed[i] = ModMetadataImpl::createInvalidMetadata(
+                    packages[i], fmt::format("Failed to parse: {}", e.what()), std::nullopt
+                );
+            }
+            parseSpan.setMod(parsed[i].getID());
+        }
+    };
+    struct CountDown {
+        std::shared_ptr<std::latch> latch;
+        ~CountDown() {
+            latch->count_down();
+        }
+    };
+    struct Wait {
+        std::latch& latch;
+        ~Wait() {
+            latch.wait();
+        }
+    };
 
-            log::debug("Found {}", entry.path().filename());
-            log::NestScope nest;
-
-            auto modMetadata = ModMetadata::createFromGeodeFile(entry.path());
+    // the main thread pulls its weight too, so there's one helper less
+    auto helpers = std::min(packages.size(), this->getFanOutWidth()) - (packages.empty() ? 0 : 1);
+    // shared since a helper may still be inside count_down when the wait
+    // returns, everything else is done with by then
+    auto done = std::make_shared<std::latch>(helpers);
+    for (size_t i = 0; i < helpers; ++i) {
+        async::runtime().spawnBlocking<void>([&parse, done] {
+            CountDown countDown { done };
+            parse();
+        });
+    }
+    {
+        // the helpers have to be done before anything here goes out of
+        // scope, even if this thread is unwinding
+        Wait wait { *done };
+        parse();
+    }
 
-            log::debug("id: {}", modMetadata.getID());
-            log::debug("version: {}", modMetadata.getVersion());
-            log::debug("early: {}", modMetadata.needsEarlyLoad() ? "yes" : "no");
+    // merge on this thread in the order the packages were found, so the
+    // queue and the log come out the same no matter who parsed what
+    StringSet queuedIDs;
+    for (auto const& item : modQueue) {
+        queuedIDs.emplace(item.getID().view());
+    }
+    for (size_t i = 0; i < packages.size(); ++i) {
+        auto& modMetadata = parsed[i];
 
-            if (std::find_if(modQueue.begin(), modQueue.end(), [&](auto& item) {
-                    return modMetadata.getID() == item.getID();
-                }) != modQueue.end()) {
-                log::error("Failed to queue: a mod with the same ID is already queued");
+        log::debug("Found {}", packages[i].filename());
+        log::NestScope nest;
+        log::debug("id: {}", modMetadata.getID());
+        log::debug("version: {}", modMetadata.getVersion());
+        log::debug("early: {}", modMetadata.needsEarlyLoad() ? "yes" : "no");
+
+        if (!queuedIDs.emplace(modMetadata.getID().view()).second) {
+            log::error("Failed to queue: a mod with the same ID is already queued");
+
+            auto invalidMetadata = ModMetadataImpl::createInvalidMetadata(
+                packages[i],
+                "A mod with the same ID is already present.",
+                // Passing `nullopt` to `createInvalidMetadata` generates a
+                // random non-conflicting ID
+                std::nullopt
+            );
+            queuedIDs.emplace(invalidMetadata.getID().view());
+            modQueue.push_back(std::move(invalidMetadata));
 
-                auto modMetadata = ModMetadataImpl::createInvalidMetadata(
-                    entry.path(),
-                    "A mod with the same ID is already present.",
-                    // Passing `nullopt` to `createInvalidMetadata` generates a
-                    // random non-conflicting ID
-                    std::nullopt
-                );
-                modQueue.push_back(modMetadata);
+            continue;
+        }
 
-                continue;
-            }
+        modQueue.push_back(std::move(modMetadata));
+    }
 
-            modQueue.push_back(modMetadata);
-        }
+    if (auto res = index.save(); !res) {
+        log::warn("Failed to save mod metadata index: {}", res.unwrapErr());
     }
 }
 
@@ -434,6 +558,7 @@ void Loader::Impl::populateModList(std::vector<ModMetadata>& modQueue) {
 
 void Loader::Impl::buildModGraph() {
     for (auto const& [id, mod] : m_mods) {
+        startup::ScopedSpan span(startup::Phase::BuildModGraph, id);
         log::debug("{}", mod->getID());
         log::NestScope nest;
         for (auto& dependency : mod->m_impl->m_metadata.m_impl->m_dependencies) {
@@ -465,6 +590,120 @@ void Loader::Impl::buildModGraph() {
     }
 }
 
+void Loader::Impl::startExtractions() {
+    struct Job {
+        Mod* mod;
+        ModMetadata metadata;
+        std::promise<Result<>> promise;
+    };
+    struct Jobs {
+        std::vector<Job> jobs;
+        std::atomic_size_t next = 0;
+    };
+
+    // Extracting is independent of the load order, so every package can be
+    // extracted as soon as it's known which ones will be loaded. Jobs are
+    // handed out in load order so the first ones needed are done first
+    auto jobs = std::make_shared<Jobs>();
+    jobs->jobs.reserve(m_modsToLoad.size());
+    // Nothing is loaded yet, so the dependency check of loadModGraph can't be
+    // asked directly. Dependencies come first in the load order, so it's
+    // enough that every required one is loaded already or will be loaded
+    std::unordered_set<Mod*> willLoad;
+    auto dependenciesWillResolve = [&](Mod* mod) {
+        for (auto const& dependency : mod->getMetadata().getDependencies()) {
+            if (!dependency.isRequired() || dependency.isResolved()) {
+                continue;
+            }
+            auto dep = dependency.getMod();
+            if (!dep || !dep->shouldLoad() || !willLoad.contains(dep)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    for (auto mod : m_modsToLoad) {
+        // same checks as loadModGraph, no point extracting these
+        if (!mod->getMetadata().checkGameVersion() || !mod->getMetadata().checkGeodeVersion()) {
+            continue;
+        }
+        if (!dependenciesWillResolve(mod) || mod->hasUnresolvedIncompatibilities()) {
+            continue;
+        }
+        willLoad.insert(mod);
+        auto& job = jobs->jobs.emplace_back(Job { mod, mod->getMetadata() });
+        m_extractions.emplace(mod, job.promise.get_future().share());
+    }
+
+    auto workers = std::min(jobs->jobs.size(), this->getFanOutWidth());
+    for (size_t i = 0; i < workers; ++i) {
+        async::runtime().spawnBlocking<void>([this, jobs] {
+            while (true) {
+                auto i = jobs->next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= jobs->jobs.size()) break;
+                auto& job = jobs->jobs[i];
+                startup::ScopedSpan span(startup::Phase::Unzip, job.metadata.getID());
+                log::debug("Unzipping {}", job.metadata.getID());
+                try {
+                    job.promise.set_value(this->unzipGeodeFile(std::move(job.metadata)));
+                }
+                catch (std::exception const& e) {
+                    job.promise.set_value(Err(fmt::format("Failed to extract: {}", e.what())));
+                }
+            }
+        });
+    }
+}
+
+void Loader::Impl::startExtraction(Mod* mod) {
+    // same checks as loadModGraph, no point extracting these. Called right
+    // before it, so the dependencies have had their chance to load
+    if (!mod->getMetadata().checkGameVersion() || !mod->getMetadata().checkGeodeVersion()) {
+        return;
+    }
+    if (mod->hasUnresolvedDependencies() || mod->hasUnresolvedIncompatibilities()) {
+        return;
+    }
+    if (m_extractions.contains(mod)) {
+        return;
+    }
+
+    auto promise = std::make_shared<std::promise<Result<>>>();
+    m_extractions.emplace(mod, promise->get_future().share());
+
+    auto nest = log::saveNest();
+    async::runtime().spawnBlocking<void>([this, promise, nest, metadata = mod->getMetadata()]() mutable {
+        log::loadNest(nest);
+        startup::ScopedSpan span(startup::Phase::Unzip, metadata.getID());
+        log::debug("Unzipping .geode file");
+        // a waiting load can't be left hanging on a broken promise
+        try {
+            promise->set_value(this->unzipGeodeFile(std::move(metadata)));
+        }
+        catch (std::exception const& e) {
+            promise->set_value(Err(fmt::format("Failed to extract: {}", e.what())));
+        }
+    });
+}
+
+bool Loader::Impl::isExtractionDone(Mod* mod) const {
+    auto it = m_extractions.find(mod);
+    return it == m_extractions.end() ||
+        it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+Result<> Loader::Impl::extract(Mod* mod) {
+    if (auto it = m_extractions.find(mod); it != m_extractions.end()) {
+        auto res = it->second.get();
+        m_extractions.erase(it);
+        return res;
+    }
+    // not started ahead of time, do it here
+    startup::ScopedSpan span(startup::Phase::Unzip, mod->getID().view());
+    log::debug("Unzipping .geode file");
+    return this->unzipGeodeFile(mod->getMetadata());
+}
+
 void Loader::Impl::loadModGraph(Mod* node, bool early) {
     // Check version first, as it's not worth trying to load a mod with an
     // invalid target version
@@ -495,12 +734,6 @@ void Loader::Impl::loadModGraph(Mod* node, bool early) {
     m_refreshedModCount += 1;
     m_lateRefreshedModCount += early ? 0 : 1;
 
-    auto unzipFunction = [this, node]() {
-        log::debug("Unzipping .geode file");
-        auto res = this->unzipGeodeFile(node->getMetadata());
-        return res;
-    };
-
     auto loadFunction = [this, node, early]() {
         if (node->shouldLoad()) {
             log::debug("Loading binary");
@@ -520,37 +753,16 @@ void Loader::Impl::loadModGraph(Mod* node, bool early) {
         m_refreshingModCount -= 1;
     };
 
-    if (early) {
-        auto res = unzipFunction();
-        if (!res) {
-            this->addProblem({ LoadProblem::Type::Unknown, node, res.unwrapErr() });
-            log::error("Failed to unzip: {}", res.unwrapErr());
-            m_refreshingModCount -= 1;
-            return;
-        }
-        loadFunction();
-    }
-    else {
-        auto nest = log::saveNest();
-
-        async::runtime().spawnBlocking<void>([=, this]() {
-            log::loadNest(nest);
-            auto res = unzipFunction();
-            this->queueInMainThread([=, this, res = std::move(res)]() {
-                auto prevNest = log::saveNest();
-                log::loadNest(nest);
-                if (!res) {
-                    this->addProblem({ LoadProblem::Type::Unknown, node, res.unwrapErr() });
-                    log::error("Failed to unzip: {}", res.unwrapErr());
-                    m_refreshingModCount -= 1;
-                    log::loadNest(prevNest);
-                    return;
-                }
-                loadFunction();
-                log::loadNest(prevNest);
-            });
-        });
+    // Usually extracted ahead of time by startExtractions, this only waits
+    // if this package isn't done yet
+    auto res = this->extract(node);
+    if (!res) {
+        this->addProblem({ LoadProblem::Type::Unknown, node, res.unwrapErr() });
+        log::error("Failed to unzip: {}", res.unwrapErr());
+        m_refreshingModCount -= 1;
+        return;
     }
+    loadFunction();
 }
 
 void Loader::Impl::findProblems() {
@@ -794,6 +1006,9 @@ void Loader::Impl::refreshModGraph() {
         this->orderModStack();
     }
 
+    log::info("Starting extractions");
+    this->startExtractions();
+
     m_loadingState = LoadingState::EarlyMods;
     log::info("Loading early mods");
     {
@@ -885,16 +1100,28 @@ void Loader::Impl::continueRefreshModGraph() {
     switch (m_loadingState) {
         case LoadingState::Mods:
             if (!m_modsToLoad.empty()) {
-                auto mod = m_modsToLoad.front();
-                m_modsToLoad.pop_front();
-                log::info("Loading mod {} {}", mod->getID(), mod->getVersion());
-                this->loadModGraph(mod, false);
+                // Load as many mods as fit in the budget. It's only checked
+                // between mods, so a slow one ends the batch
+                auto batchStart = std::chrono::steady_clock::now();
+                do {
+                    auto mod = m_modsToLoad.front();
+                    // packages are extracted on blocking threads, rather than
+                    // stalling the loading screen check again next frame.
+                    // Starting it here only matters if it wasn't already
+                    this->startExtraction(mod);
+                    if (!this->isExtractionDone(mod)) break;
+                    m_modsToLoad.pop_front();
+                    log::info("Loading mod {} {}", mod->getID(), mod->getVersion());
+                    this->loadModGraph(mod, false);
+                } while (!m_modsToLoad.empty() && std::chrono::steady_clock::now() - batchStart < m_modLoadBudget);
                 break;
             }
             m_loadingState = LoadingState::Problems;
             [[fallthrough]];
 
         case LoadingState::Problems:
+            // mods that didn't get to loading never picked theirs up
+            m_extractions.clear();
             log::info("Finding problems");
             {
                 log::NestScope nest;
@@ -916,9 +1143,11 @@ void Loader::Impl::continueRefreshModGraph() {
     }
 
     if (m_loadingState != LoadingState::Done) {
-        queueInMainThread([this]() {
+        // high priority so the batch gets its full budget instead of
+        // sharing the frame budget with everything else that's queued
+        this->queueInMainThread([this]() {
             this->continueRefreshModGraph();
-        });
+        }, MainThreadPriority::High);
     }
     else {
         GameEvent(GameEventType::ModsLoaded).send();
@@ -947,6 +1176,8 @@ void Loader::Impl::addUninitializedHook(Hook* hook, Mod* mod) {
     m_uninitializedHooks.emplace_back(hook, mod);
 }
 
+static constexpr int EXTRACTION_MANIFEST_VERSION = 1;
+
 static bool isPlatformBinary(std::string_view modID, std::string_view filename) {
     if (!filename.starts_with(modID)) {
         return false;
@@ -962,29 +1193,61 @@ static bool isPlatformBinary(std::string_view modID, std::string_view filename)
 Result<> Loader::Impl::unzipGeodeFile(ModMetadata metadata) {
     // Unzip .geode file into temp dir
     auto tempDir = dirs::getModRuntimeDir() / metadata.getID();
-
-    auto datePath = tempDir / "modified-at";
-    std::string currentHash = file::readString(datePath).unwrapOr("");
+    auto manifestPath = tempDir / EXTRACTION_MANIFEST;
 
     std::error_code ec;
+    auto packageSize = std::filesystem::file_size(metadata.getPath(), ec);
     auto modifiedDate = std::filesystem::last_write_time(metadata.getPath(), ec);
     if (ec) {
         auto message = formatSystemError(ec.value());
         return Err("Unable to get last modified time of zip: " + message);
     }
-    auto modifiedCount = std::chrono::duration_cast<std::chrono::milliseconds>(modifiedDate.time_since_epoch());
-    auto modifiedHash = std::to_string(modifiedCount.count());
-    if (currentHash == modifiedHash) {
-        log::debug("Same hash detected, skipping unzip");
-        return Ok();
+    auto modified = std::chrono::duration_cast<std::chrono::milliseconds>(modifiedDate.time_since_epoch()).count();
+
+    // The manifest lists every file that was extracted from the package
+    // along with the size and CRC32 the zip had for it, so when the package
+    // changes only the entries that differ have to be written again
+    struct ExtractedEntry {
+        uint64_t size;
+        uint32_t crc32;
+    };
+    StringMap<ExtractedEntry> extracted;
+    if (auto json = file::readJson(manifestPath)) {
+        auto& root = json.unwrap();
+        if (root["version"].asInt().unwrapOr(0) == EXTRACTION_MANIFEST_VERSION) {
+            if (
+                root["size"].asInt().unwrapOr(-1) == static_cast<intmax_t>(packageSize) &&
+                root["modified"].asInt().unwrapOr(-1) == modified
+            ) {
+                log::debug("Package unchanged, skipping unzip");
+                return Ok();
+            }
+            if (auto entries = root["entries"].asArray()) {
+                for (auto& entry : entries.unwrap()) {
+                    auto path = entry["path"].asString();
+                    auto size = entry["size"].asInt();
+                    auto crc = entry["crc"].asInt();
+                    if (!path || !size || !crc) continue;
+                    extracted[path.unwrap()] = ExtractedEntry {
+                        .size = static_cast<uint64_t>(size.unwrap()),
+                        .crc32 = static_cast<uint32_t>(crc.unwrap()),
+                    };
+                }
+            }
+        }
     }
-    log::debug("Hash mismatch detected, unzipping");
+    log::debug("Package changed, updating extracted files");
 
-    std::filesystem::remove_all(tempDir, ec);
+    // The manifest stops describing the directory as soon as a file in it
+    // changes, so it goes first. If we get interrupted, the next launch finds
+    // no manifest and checks the files that are there against the zip instead
+    std::filesystem::remove(manifestPath, ec);
     if (ec) {
         auto message = formatSystemError(ec.value());
-        return Err("Unable to delete temp dir: " + message GEODE_WINDOWS( + " Try restarting your PC if the problem persists."));
+        return Err("Unable to delete extraction manifest: " + message GEODE_WINDOWS( + " Try restarting your PC if the problem persists."));
     }
+    // Left over from before there was a manifest
+    std::filesystem::remove(tempDir / "modified-at", ec);
 
     (void)utils::file::createDirectoryAll(tempDir);
 
@@ -994,25 +1257,90 @@ Result<> Loader::Impl::unzipGeodeFile(ModMetadata metadata) {
             fmt::format("Unable to find platform binary under the name \"{}\"", metadata.getBinaryName())
         );
     }
-    GEODE_UNWRAP(unzip.extractAllTo(tempDir));
 
-    // Delete binaries for other platforms since they're pointless
-    // The if should never fail, but you never know
-    for (auto& entry : std::filesystem::directory_iterator(tempDir)) {
-        if (entry.is_directory()) {
-            continue;
+    // Paths are compared case-insensitively where the filesystem is, so a
+    // file that was renamed to a different case in the package isn't deleted
+    // right after being written
+    auto wantedKey = [](std::filesystem::path const& path) {
+        auto key = utils::string::pathToString(path.lexically_normal());
+    #if defined(GEODE_IS_WINDOWS) || defined(GEODE_IS_MACOS)
+        utils::string::toLowerIP(key);
+    #endif
+        return key;
+    };
+
+    auto base = tempDir.lexically_normal();
+    auto manifest = matjson::Value::array();
+    StringSet wanted;
+    size_t written = 0;
+    size_t kept = 0;
+    // One pass over the central directory, extracting as it goes. Looking
+    // every entry up by name again would be quadratic in the entry count
+    GEODE_UNWRAP(unzip.extractEach([&](file::Unzip::EntryInfo const& entry) -> std::optional<std::filesystem::path> {
+        auto target = (tempDir / entry.path).lexically_normal();
+        auto relative = target.lexically_relative(base);
+        if (relative.empty() || *relative.begin() == "..") {
+            log::error("Zip entry \"{}\" is not contained within zip bounds", entry.path);
+            return std::nullopt;
+        }
+        if (entry.isDirectory) {
+            (void)utils::file::createDirectoryAll(target);
+            return std::nullopt;
         }
 
-        const std::string filename = utils::string::pathToString(entry.path().filename());
-        if (metadata.getBinaryName() == filename || !isPlatformBinary(metadata.getID(), filename)) {
-            continue;
+        // Binaries for other platforms are pointless
+        auto filename = utils::string::pathToString(entry.path.filename());
+        if (
+            !entry.path.has_parent_path() &&
+            metadata.getBinaryName() != filename &&
+            isPlatformBinary(metadata.getID(), filename)
+        ) {
+            return std::nullopt;
         }
 
-        // The binary is not for our platform, delete!
-        // We don't really care if the deletion succeeds though.
-        std::error_code ec;
-        std::filesystem::remove(entry.path(), ec);
+        auto name = utils::string::pathToString(entry.path);
+        wanted.insert(wantedKey(target));
+        manifest.push(matjson::makeObject({
+            { "path", name },
+            { "size", entry.size },
+            { "crc", entry.crc32 },
+        }));
+
+        // A file is only trusted without reading it if the manifest says we
+        // wrote this exact entry there, otherwise its checksum has to match
+        bool upToDate = false;
+        if (std::filesystem::file_size(target, ec) == entry.size && !ec) {
+            auto it = extracted.find(name);
+            if (it != extracted.end()) {
+                upToDate = it->second.crc32 == entry.crc32 && it->second.size == entry.size;
+            }
+            else {
+                upToDate = file::readCRC32(target).unwrapOr(~entry.crc32) == entry.crc32;
+            }
+        }
+        if (upToDate) {
+            kept += 1;
+            return std::nullopt;
+        }
+        written += 1;
+        return target;
+    }));
+
+    // Remove whatever is left from older versions of the package
+    std::vector<std::filesystem::path> stale;
+    for (auto& file : std::filesystem::recursive_directory_iterator(tempDir, ec)) {
+        if (file.is_directory()) {
+            continue;
+        }
+        if (!wanted.contains(wantedKey(file.path()))) {
+            stale.push_back(file.path());
+        }
+    }
+    for (auto& path : stale) {
+        // We don't really care if the deletion succeeds though
+        std::filesystem::remove(path, ec);
     }
+    log::debug("Wrote {} files, kept {}, removed {}", written, kept, stale.size());
 
     // Check if there is a binary that we need to move over from the unzipped binaries dir
     if (this->isPatchless()) {
@@ -1032,9 +1360,14 @@ Result<> Loader::Impl::unzipGeodeFile(ModMetadata metadata) {
         }
     }
 
-    auto res = file::writeString(datePath, modifiedHash);
+    auto json = matjson::Value::object();
+    json["version"] = EXTRACTION_MANIFEST_VERSION;
+    json["size"] = packageSize;
+    json["modified"] = modified;
+    json["entries"] = std::move(manifest);
+    auto res = file::writeStringSafe(manifestPath, json.dump(matjson::NO_INDENTATION));
     if (!res) {
-        log::warn("Failed to write modified date of geode zip, will try to unzip next launch: {}", res.unwrapErr());
+        log::warn("Failed to write extraction manifest, will check extracted files again next launch: {}", res.unwrapErr());
     }
 
     return Ok();
@@ -1063,7 +1396,15 @@ Result<> Loader::Impl::extractBinary(ModMetadata metadata) {
 bool Loader::Impl::loadHooks() {
     m_readyToHook = true;
     bool hadErrors = false;
+    // hooks are registered a mod at a time, so a span per run of the same
+    // mod gives one per mod without having to sort them
+    std::optional<startup::ScopedSpan> span;
+    Mod* spanMod = nullptr;
     for (auto const& [hook, mod] : m_uninitializedHooks) {
+        if (!span || mod != spanMod) {
+            span.emplace(startup::Phase::LoadHooks, mod ? mod->getID().view() : std::string_view());
+            spanMod = mod;
+        }
         auto res = hook->enable();
         if (!res) {
             log::logImpl(Severity::Error, mod, "{}", res.unwrapErr());
@@ -1074,33 +1415,112 @@ bool Loader::Impl::loadHooks() {
     return !hadErrors;
 }
 
-void Loader::Impl::queueInMainThread(ScheduledFunction&& func) {
-    std::lock_guard<std::mutex> lock(m_mainThreadMutex);
-    m_mainThreadQueue.push_back(std::move(func));
+void Loader::Impl::queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority, Mod* owner) {
+    // counted before pushing, so that the count can't go below zero when
+    // the main thread drains it right away
+    m_mainThreadQueued[static_cast<size_t>(priority)].fetch_add(1, std::memory_order_relaxed);
+    m_mainThreadQueue.push(MainThreadTask{ std::move(func), {}, priority, std::chrono::steady_clock::now(), owner });
+}
+
+void Loader::Impl::queueInMainThreadCoalesced(std::string key, ScheduledFunction&& func, MainThreadPriority priority, Mod* owner) {
+    {
+        std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+        auto [it, inserted] = m_mainThreadCoalesced.try_emplace(key, std::move(func));
+        if (!inserted) {
+            // the queued task picks up the new function when it runs
+            it->second = std::move(func);
+            m_mainThreadStats.coalesced += 1;
+            return;
+        }
+    }
+    m_mainThreadQueued[static_cast<size_t>(priority)].fetch_add(1, std::memory_order_relaxed);
+    m_mainThreadQueue.push(MainThreadTask{ {}, std::move(key), priority, std::chrono::steady_clock::now(), owner });
 }
 
 void Loader::Impl::executeMainThreadQueue() {
-    m_mainThreadMutex.lock();
+    using namespace std::chrono;
+    GEODE_PROFILE_ZONE("Main thread queue");
+
+    // submitting never takes a lock, and the whole queue is taken in one
+    // atomic exchange
+    m_mainThreadPending.take(m_mainThreadQueue, [this](size_t priority) {
+        m_mainThreadQueued[priority].fetch_sub(1, std::memory_order_relaxed);
+    });
+
+    auto const start = steady_clock::now();
+    auto const fullBudget = duration_cast<nanoseconds>(m_mainThreadBudget.load(std::memory_order_relaxed));
+    auto const budget = fullBudget - m_mainThreadBudgetDebt;
 
-    // to prevent allocating an extra vector every frame we have a separate temp queue,
-    // where we first move all functions before executing them.
-    // this means there are no allocations in the common case, and we maintain deadlock safety
-    // since we do not call any functions while holding the mutex
+    nanoseconds latencySum{0};
+    nanoseconds maxLatency{0};
+    auto now = start;
 
-    auto& queue = m_mainThreadQueue;
-    auto& execQueue = m_mainThreadQueueExec;
-    execQueue.reserve(queue.size());
-    std::move(queue.begin(), queue.end(), std::back_inserter(execQueue));
-    queue.clear();
+    auto runs = m_mainThreadPending.runFrame([&](MainThreadTask& task) {
+        auto latency = now - task.queuedAt;
+        latencySum += latency;
+        maxLatency = std::max(maxLatency, latency);
+
+        if (!task.coalesceKey.empty()) {
+            std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+            if (auto it = m_mainThreadCoalesced.find(task.coalesceKey); it != m_mainThreadCoalesced.end()) {
+                task.func = std::move(it->second);
+                m_mainThreadCoalesced.erase(it);
+            }
+        }
+        if (task.func) {
+            GEODE_PROFILE_ZONE("Queued function");
+            watchdog::Scope scope(task.owner, task.coalesceKey.empty() ? "queued function" : "coalesced function");
+            task.func();
+        }
+        now = steady_clock::now();
+    }, [&] {
+        return now - start < budget;
+    });
 
-    m_mainThreadMutex.unlock();
+    auto const elapsed = now - start;
+    // an overrun is paid back by the next frame, but only the next one, so
+    // that a single slow function doesn't throttle the queue for a while
+    m_mainThreadBudgetDebt = std::clamp(elapsed - fullBudget, nanoseconds(0), fullBudget);
 
-    // call all functions
-    for (auto& func : execQueue) {
-        func();
+    std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+    auto& stats = m_mainThreadStats;
+    for (size_t i = 0; i < stats.pending.size(); i++) {
+        stats.pending[i] = m_mainThreadPending.size(i);
+    }
+    stats.lastFrameRuns = runs;
+    stats.lastFrameTime = duration_cast<microseconds>(elapsed);
+    if (runs > 0) {
+        // moving average over roughly the last 16 frames with work
+        m_mainThreadAverageLatency += (latencySum / static_cast<int64_t>(runs) - m_mainThreadAverageLatency) / 16;
+        stats.averageLatency = duration_cast<microseconds>(m_mainThreadAverageLatency);
+        stats.maxLatency = std::max(stats.maxLatency, duration_cast<microseconds>(maxLatency));
+    }
+    if (!m_mainThreadPending.empty()) {
+        stats.budgetExceededFrames += 1;
     }
+}
+
+void Loader::Impl::setMainThreadBudget(std::chrono::microseconds budget) {
+    m_mainThreadBudget.store(std::max(budget, std::chrono::microseconds(0)), std::memory_order_relaxed);
+}
 
-    execQueue.clear();
+size_t Loader::Impl::getFanOutWidth() const {
+    // the jobs mostly wait on file io, so by default there are as many as
+    // there are workers
+    return m_fanOutWidth > 0 ? m_fanOutWidth : async::workerCount();
+}
+
+std::chrono::microseconds Loader::Impl::getMainThreadBudget() const {
+    return m_mainThreadBudget.load(std::memory_order_relaxed);
+}
+
+MainThreadQueueStats Loader::Impl::getMainThreadQueueStats() const {
+    std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+    auto stats = m_mainThreadStats;
+    for (size_t i = 0; i < stats.pending.size(); i++) {
+        stats.pending[i] += m_mainThreadQueued[i].load(std::memory_order_relaxed);
+    }
+    return stats;
 }
 
 void Loader::Impl::provideNextMod(Mod* mod) {
@@ -1121,6 +1541,20 @@ void Loader::Impl::releaseNextMod() {
     m_nextModLock.unlock();
 }
 
+void Loader::Impl::setupLaunchArguments() {
+    // called from geodeEntry before the logger starts, and again from setup
+    if (m_launchArgsLoaded) {
+        return;
+    }
+    m_launchArgsLoaded = true;
+
+    if (this->supportsLaunchArguments()) {
+        log::info("Loading launch arguments");
+        log::NestScope nest;
+        this->initLaunchArguments();
+    }
+}
+
 // TODO: Support for quoted launch args w/ spaces (this will be backwards compatible)
 // e.g. "--geode:arg=My spaced value"
 void Loader::Impl::initLaunchArguments() {
@@ -7,11 +7,18 @@
 #include <Geode/loader/Mod.hpp>
 #include <Geode/Result.hpp>
 #include <Geode/utils/map.hpp>
+#include <Geode/utils/MPSCQueue.hpp>
 #include <Geode/utils/ranges.hpp>
 #include <Geode/utils/function.hpp>
 #include <Geode/utils/StringMap.hpp>
 #include "ModImpl.hpp"
+#include "MainThreadQueue.hpp"
 #include <crashlog.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
 #include <mutex>
 #include <optional>
 #include <thread>
@@ -40,9 +47,30 @@ namespace geode {
 
         LoadingState m_loadingState = LoadingState::None;
 
-        std::vector<geode::Function<void(void)>> m_mainThreadQueue;
-        std::vector<geode::Function<void(void)>> m_mainThreadQueueExec; // see comments in loaderimpl.cpp for the purpose
+        struct MainThreadTask {
+            ScheduledFunction func;
+            // Coalesced functions are kept in m_mainThreadCoalesced instead,
+            // so they can be replaced until they run
+            std::string coalesceKey;
+            MainThreadPriority priority;
+            std::chrono::steady_clock::time_point queuedAt;
+            Mod* owner;
+        };
+        // Submitted functions, moved into m_mainThreadPending once per frame
+        utils::MPSCQueue<MainThreadTask, true> m_mainThreadQueue;
+        // Number of functions in m_mainThreadQueue, per priority
+        std::array<std::atomic_size_t, 3> m_mainThreadQueued {};
+        // Only taken for coalesced functions and stats
+        StringMap<ScheduledFunction> m_mainThreadCoalesced;
         mutable std::mutex m_mainThreadMutex;
+        // Tasks left over from previous frames, only touched on the main thread
+        main_thread::PendingTasks<MainThreadTask> m_mainThreadPending;
+        std::atomic<std::chrono::microseconds> m_mainThreadBudget = std::chrono::microseconds(4000);
+        std::chrono::nanoseconds m_mainThreadBudgetDebt{0};
+        std::chrono::nanoseconds m_mainThreadAverageLatency{0};
+        // Guarded by m_mainThreadMutex. The pending counts only cover the
+        // leftover tasks, as of the end of the last frame
+        MainThreadQueueStats m_mainThreadStats;
         std::vector<std::pair<Hook*, Mod*>> m_uninitializedHooks;
         bool m_readyToHook = false;
 
@@ -57,8 +85,20 @@ namespace geode {
         int m_refreshingModCount = 0;
         int m_refreshedModCount = 0;
         int m_lateRefreshedModCount = 0;
+        // How long a frame may spend loading late mods, checked between mods.
+        // Set with the `mod-load-budget` launch argument, in milliseconds
+        std::chrono::microseconds m_modLoadBudget = std::chrono::microseconds(8000);
+        // How many blocking jobs the loader spreads parsing and extracting
+        // mods over. Only the loader's own fan-out, the runtime's blocking
+        // pool keeps its size. Set with the `loader-fan-out` launch argument,
+        // 0 means the async worker count
+        size_t m_fanOutWidth = 0;
+        // Extractions running off the main thread, started ahead of loading
+        // by startExtractions. Only touched on the main thread
+        std::unordered_map<Mod*, std::shared_future<Result<>>> m_extractions;
 
         utils::StringMap<std::string> m_launchArgs;
+        bool m_launchArgsLoaded = false;
 
         std::chrono::time_point<std::chrono::high_resolution_clock> m_timerBegin;
 
@@ -106,6 +146,10 @@ namespace geode {
         void populateModList(std::vector<ModMetadata>& modQueue);
         void buildModGraph();
         void orderModStack();
+        void startExtractions();
+        void startExtraction(Mod* mod);
+        bool isExtractionDone(Mod* mod) const;
+        Result<> extract(Mod* mod);
         void loadModGraph(Mod* node, bool early);
         void findProblems();
         void refreshModGraph();
@@ -121,6 +165,7 @@ namespace geode {
         bool supportsLaunchArguments() const;
         std::string getLaunchCommand() const;
         void initLaunchArguments();
+        void setupLaunchArguments();
         std::vector<std::string> getLaunchArgumentNames() const;
         bool hasLaunchArgument(std::string_view name) const;
         std::optional<std::string> getLaunchArgument(std::string_view name) const;
@@ -128,8 +173,13 @@ namespace geode {
 
         void updateResources(bool forceReload);
 
-        void queueInMainThread(ScheduledFunction&& func);
+        void queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority = MainThreadPriority::High, Mod* owner = nullptr);
+        void queueInMainThreadCoalesced(std::string key, ScheduledFunction&& func, MainThreadPriority priority, Mod* owner);
         void executeMainThreadQueue();
+        void setMainThreadBudget(std::chrono::microseconds budget);
+        std::chrono::microseconds getMainThreadBudget() const;
+        size_t getFanOutWidth() const;
+        MainThreadQueueStats getMainThreadQueueStats() const;
 
         bool isReadyToHook() const;
         void addUninitializedHook(Hook* hook, Mod* mod);
@@ -137,6 +187,10 @@ namespace geode {
         Mod* getInternalMod();
         Result<> setupInternalMod();
 
+        // Lists what unzipGeodeFile extracted into a mod's runtime dir,
+        // removing it makes the next unzip check every file
+        static constexpr auto EXTRACTION_MANIFEST = "extracted.json";
+
         // called on a separate thread
         Result<> unzipGeodeFile(ModMetadata metadata);
 
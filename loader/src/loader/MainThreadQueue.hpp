@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+// The per-frame step behind Loader::queueInMainThread. Only uses the standard
+// library, so that it can be tested on the host (see test/host)
+namespace geode::main_thread {
+    // Priorities are indices here, High being 0
+    constexpr size_t PRIORITY_COUNT = 3;
+
+    // Functions taken from the submit queue that haven't run yet. Only ever
+    // touched on the main thread
+    template <class Task>
+    class PendingTasks final {
+        std::array<std::deque<Task>, PRIORITY_COUNT> m_pending;
+
+    public:
+        // Takes everything submitted since the last frame in one go. Functions
+        // left over from earlier frames stay ahead of the new ones
+        template <class Queue, class OnTaken>
+        void take(Queue& queue, OnTaken&& onTaken) {
+            queue.drain([&](Task& task) {
+                auto priority = static_cast<size_t>(task.priority);
+                onTaken(priority);
+                m_pending[priority].push_back(std::move(task));
+            });
+        }
+
+        // Runs every high priority function, budget or not. The rest run
+        // while `hasBudget()` says so, but always at least one of each
+        // priority, so that nothing is stuck behind a long stream of other
+        // functions. Returns how many ran
+        template <class Run, class HasBudget>
+        size_t runFrame(Run&& run, HasBudget&& hasBudget) {
+            size_t runs = 0;
+            auto runNext = [&](std::deque<Task>& pending) {
+                auto task = std::move(pending.front());
+                pending.pop_front();
+                run(task);
+                runs += 1;
+            };
+
+            auto& high = m_pending[0];
+            while (!high.empty()) {
+                runNext(high);
+            }
+            for (size_t priority = 1; priority < PRIORITY_COUNT; ++priority) {
+                auto& pending = m_pending[priority];
+                bool ranOne = false;
+                while (!pending.empty() && (!ranOne || hasBudget())) {
+                    runNext(pending);
+                    ranOne = true;
+                }
+            }
+            return runs;
+        }
+
+        size_t size(size_t priority) const {
+            return m_pending[priority].size();
+        }
+
+        bool empty() const {
+            for (auto& pending : m_pending) {
+                if (!pending.empty()) return false;
+            }
+            return true;
+        }
+    };
+}
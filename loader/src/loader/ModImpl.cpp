@@ -3,6 +3,7 @@
 #include "ModMetadataImpl.hpp"
 #include "HookImpl.hpp"
 #include "PatchImpl.hpp"
+#include "StartupTimelineImpl.hpp"
 #include "about.hpp"
 #include "console.hpp"
 
@@ -318,9 +319,11 @@ Result<> Mod::Impl::loadBinary() {
     if (m_loaded)
         return Ok();
 
+    startup::ScopedSpan span(startup::Phase::LoadBinary, m_metadata.getID());
+
     if (!std::filesystem::exists(this->getBinaryPath())) {
         std::error_code ec;
-        std::filesystem::remove(m_tempDirName / "modified-at", ec);
+        std::filesystem::remove(m_tempDirName / LoaderImpl::EXTRACTION_MANIFEST, ec);
         return Err(
             fmt::format(
                 "Failed to load {}: No binary could be found for current platform.\n"
@@ -353,7 +356,10 @@ Result<> Mod::Impl::loadBinary() {
 
     LoaderImpl::get()->releaseNextMod();
 
-    ModStateEvent(ModEventType::Loaded, std::move(m_self)).send();
+    {
+        startup::ScopedSpan span(startup::Phase::LoadedHandlers, m_metadata.getID());
+        ModStateEvent(ModEventType::Loaded, std::move(m_self)).send();
+    }
     ModStateEvent(ModEventType::DataLoaded, std::move(m_self)).send();
 
     // do we not have a function for getting all the dependencies of a mod directly? ok then
@@ -1,3 +1,4 @@
+#include <Geode/loader/Dirs.hpp>
 #include <Geode/loader/Loader.hpp>
 #include <Geode/utils/JsonValidation.hpp>
 #include <Geode/utils/VersionInfo.hpp>
@@ -6,9 +7,11 @@
 #include <Geode/utils/general.hpp>
 #include <Geode/utils/random.hpp>
 #include <about.hpp>
+#include <hash/hash.hpp>
 #include <matjson.hpp>
 #include <utility>
 #include <clocale>
+#include <fstream>
 
 #include "ModMetadataImpl.hpp"
 #include "LoaderImpl.hpp"
@@ -507,9 +510,21 @@ ModMetadata ModMetadata::Impl::parse(ModJson const& rawJson, std::optional<std::
     return info;
 }
 
-Result<> ModMetadata::Impl::addSpecialFiles(file::Unzip& unzip) {
+namespace {
+    // lazy loading is rare enough that one lock for all of them is fine,
+    // a mutex per metadata would make it uncopyable
+    std::mutex& pendingSpecialFilesMutex() {
+        static std::mutex s_mutex;
+        return s_mutex;
+    }
+}
+
+Result<> ModMetadata::Impl::addSpecialFiles(file::Unzip& unzip, bool includeDetails) {
     // unzip known MD files
     for (auto& [file, target] : this->getSpecialFiles()) {
+        if (!includeDetails && target == &m_details) {
+            continue;
+        }
         if (unzip.hasEntry(file)) {
             // reference to local binding 'file' declared in enclosing function
             std::string_view fileStr(file);
@@ -523,6 +538,12 @@ Result<> ModMetadata::Impl::addSpecialFiles(file::Unzip& unzip) {
 }
 
 Result<> ModMetadata::Impl::addSpecialFiles(std::filesystem::path const& dir) {
+    // the directory replaces the package as the source of these, so they
+    // mustn't be read out of the package later on
+    {
+        std::lock_guard lock(pendingSpecialFilesMutex());
+        m_specialFilesPending = false;
+    }
     // unzip known MD files
     for (auto& [file, target] : this->getSpecialFiles()) {
         if (std::filesystem::exists(dir / file)) {
@@ -536,6 +557,25 @@ Result<> ModMetadata::Impl::addSpecialFiles(std::filesystem::path const& dir) {
     return Ok();
 }
 
+void ModMetadata::Impl::loadPendingSpecialFiles() const {
+    std::lock_guard lock(pendingSpecialFilesMutex());
+    if (!m_specialFilesPending) return;
+    m_specialFilesPending = false;
+
+    auto unzip = file::Unzip::create(m_path);
+    if (!unzip) {
+        log::warn("Unable to open {} for its extra files: {}", m_path, unzip.unwrapErr());
+        return;
+    }
+    auto&& zip = std::move(unzip.unwrap());
+    // the metadata itself isn't const, only this view of it
+    // the details came from the index already
+    auto res = const_cast<Impl*>(this)->addSpecialFiles(zip, false);
+    if (!res) {
+        log::warn("Unable to add extra files for {}: {}", m_id, res.unwrapErr());
+    }
+}
+
 std::vector<std::pair<std::string, std::optional<std::string>*>> ModMetadata::Impl::getSpecialFiles() {
     return {
         {"about.md", &this->m_details},
@@ -598,12 +638,15 @@ std::optional<std::string> const& ModMetadata::getDescription() const {
     return m_impl->m_description;
 }
 std::optional<std::string> const& ModMetadata::getDetails() const {
+    // never pending, see m_specialFilesPending
     return m_impl->m_details;
 }
 std::optional<std::string> const& ModMetadata::getChangelog() const {
+    m_impl->loadPendingSpecialFiles();
     return m_impl->m_changelog;
 }
 std::optional<std::string> const& ModMetadata::getSupportInfo() const {
+    m_impl->loadPendingSpecialFiles();
     return m_impl->m_supportInfo;
 }
 ModMetadataLinks const& ModMetadata::getLinks() const {
@@ -736,12 +779,21 @@ void ModMetadata::setDescription(std::optional<std::string> value) {
     m_impl->m_description = std::move(value);
 }
 void ModMetadata::setDetails(std::optional<std::string> value) {
+    // the other special files have to be read before the package stops
+    // being their source, or a later lazy load would overwrite this one
+    m_impl->loadPendingSpecialFiles();
     m_impl->m_details = std::move(value);
 }
 void ModMetadata::setChangelog(std::optional<std::string> value) {
+    // the other special files have to be read before the package stops
+    // being their source, or a later lazy load would overwrite this one
+    m_impl->loadPendingSpecialFiles();
     m_impl->m_changelog = std::move(value);
 }
 void ModMetadata::setSupportInfo(std::optional<std::string> value) {
+    // the other special files have to be read before the package stops
+    // being their source, or a later lazy load would overwrite this one
+    m_impl->loadPendingSpecialFiles();
     m_impl->m_supportInfo = std::move(value);
 }
 void ModMetadata::setRepository(std::optional<std::string> value) {
@@ -853,6 +905,214 @@ ModMetadata ModMetadata::createFromGeodeFile(std::filesystem::path const& path)
 
     return info;
 }
+namespace {
+    constexpr int64_t INDEX_VERSION = 2;
+
+    // Checksum of a package's central directory, which has the CRC and size
+    // of every entry, so it changes with the contents without having to
+    // read more than the end of the package
+    Result<std::string> packageChecksum(std::filesystem::path const& path, uintmax_t size) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return Err("Unable to open package");
+        }
+
+        // The end of central directory record is 22 bytes followed by a
+        // comment of up to 64 KiB, which is almost always empty
+        constexpr size_t EOCD_SIZE = 22;
+        auto tailSize = static_cast<size_t>(std::min<uintmax_t>(size, EOCD_SIZE + 0xFFFF));
+        std::vector<uint8_t> tail(tailSize);
+        file.seekg(static_cast<std::streamoff>(size - tailSize));
+        file.read(reinterpret_cast<char*>(tail.data()), tailSize);
+        if (!file || tailSize < EOCD_SIZE) {
+            return Err("Unable to read end of package");
+        }
+
+        auto read32 = [&](size_t offset) {
+            return uint32_t(tail[offset]) | uint32_t(tail[offset + 1]) << 8 |
+                uint32_t(tail[offset + 2]) << 16 | uint32_t(tail[offset + 3]) << 24;
+        };
+        std::optional<size_t> eocd;
+        for (size_t i = tailSize - EOCD_SIZE + 1; i-- > 0;) {
+            if (read32(i) == 0x06054b50) {
+                eocd = i;
+                break;
+            }
+        }
+        if (!eocd) {
+            return Err("Package is not a zip file");
+        }
+
+        std::vector<uint8_t> data(tail.begin() + *eocd, tail.end());
+        auto dirSize = read32(*eocd + 12);
+        auto dirOffset = read32(*eocd + 16);
+        // Zip64 packages keep the real values elsewhere and leave these as
+        // placeholders. The record on its own wouldn't change with the
+        // contents, so those packages aren't indexed at all
+        if (dirSize == 0xFFFFFFFF || dirOffset == 0xFFFFFFFF) {
+            return Err("Zip64 packages have no checksum");
+        }
+        if (uintmax_t(dirOffset) + dirSize > size) {
+            return Err("Central directory is out of bounds");
+        }
+        auto recordSize = data.size();
+        data.resize(recordSize + dirSize);
+        file.seekg(dirOffset);
+        file.read(reinterpret_cast<char*>(data.data() + recordSize), dirSize);
+        if (!file) {
+            return Err("Unable to read central directory");
+        }
+        return Ok(calculateHash(data));
+    }
+}
+
+ModMetadataIndex::ModMetadataIndex() {
+    auto json = file::readJson(ModMetadataIndex::getPath());
+    if (!json) return;
+    auto& root = json.unwrap();
+    if (root["version"].asInt().unwrapOr(0) != INDEX_VERSION) return;
+
+    auto packages = root["packages"].asArray();
+    if (!packages) return;
+    for (auto& package : packages.unwrap()) {
+        auto path = package["path"].asString();
+        auto size = package["size"].asInt();
+        auto modified = package["modified"].asInt();
+        auto checksum = package["checksum"].asString();
+        if (!path || !size || !modified || !checksum || !package.contains("mod.json")) {
+            continue;
+        }
+        auto& entry = m_entries[path.unwrap()] = Entry {
+            .size = static_cast<uintmax_t>(size.unwrap()),
+            .modified = modified.unwrap(),
+            .checksum = checksum.unwrap(),
+            .json = package["mod.json"],
+        };
+        if (auto details = package["about.md"].asString()) {
+            entry.details = details.unwrap();
+        }
+    }
+}
+
+std::filesystem::path ModMetadataIndex::getPath() {
+    return dirs::getGeodeDir() / "metadata-index.json";
+}
+
+ModMetadata ModMetadataIndex::get(std::filesystem::path const& path) {
+    auto key = utils::string::pathToString(path);
+
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    auto modifiedTime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return ModMetadata::createFromGeodeFile(path);
+    }
+    auto modified = std::chrono::duration_cast<std::chrono::milliseconds>(modifiedTime.time_since_epoch()).count();
+
+    // The size and modification time are enough for an unchanged package,
+    // the checksum is only needed to tell whether one that was touched,
+    // copied or reinstalled actually changed
+    std::optional<matjson::Value> json;
+    std::optional<std::string> details;
+    std::optional<std::string> indexedChecksum;
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            if (it->second.size == size && it->second.modified == modified) {
+                it->second.used = true;
+                json = it->second.json;
+                details = it->second.details;
+            }
+            else {
+                indexedChecksum = it->second.checksum;
+            }
+        }
+    }
+
+    std::optional<std::string> checksum;
+    if (!json) {
+        auto res = packageChecksum(path, size);
+        if (!res) {
+            return ModMetadata::createFromGeodeFile(path);
+        }
+        checksum = std::move(res).unwrap();
+    }
+    if (checksum && checksum == indexedChecksum) {
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end() && it->second.checksum == *checksum) {
+            it->second.size = size;
+            it->second.modified = modified;
+            it->second.used = true;
+            json = it->second.json;
+            details = it->second.details;
+            m_dirty = true;
+        }
+    }
+
+    if (json) {
+        // Same as createFromGeodeFile, minus opening the package
+        std::optional<std::string> guessedID = utils::string::pathToString(path.stem());
+        if (!ModMetadata::validateID(*guessedID)) {
+            guessedID = std::nullopt;
+        }
+        auto info = ModMetadataImpl::parse(*json, guessedID);
+        auto& impl = ModMetadataImpl::getImpl(info);
+        impl.m_path = path;
+        impl.m_details = std::move(details);
+        impl.m_specialFilesPending = true;
+        return info;
+    }
+
+    auto info = ModMetadata::createFromGeodeFile(path);
+    // packages that couldn't be parsed are tried again next time
+    if (!info.wasCompletelyUnparseable()) {
+        std::lock_guard lock(m_mutex);
+        m_entries[key] = Entry {
+            .size = size,
+            .modified = modified,
+            .checksum = std::move(*checksum),
+            .json = info.getRawJSON(),
+            .details = info.getDetails(),
+            .used = true,
+        };
+        m_dirty = true;
+    }
+    return info;
+}
+
+Result<> ModMetadataIndex::save() {
+    std::lock_guard lock(m_mutex);
+    // packages that are gone need to be dropped too
+    auto stale = std::any_of(m_entries.begin(), m_entries.end(), [](auto const& item) {
+        return !item.second.used;
+    });
+    if (!m_dirty && !stale) return Ok();
+
+    auto packages = matjson::Value::array();
+    for (auto& [path, entry] : m_entries) {
+        if (!entry.used) continue;
+        auto package = matjson::Value::object();
+        package["path"] = path;
+        package["size"] = entry.size;
+        package["modified"] = entry.modified;
+        package["checksum"] = entry.checksum;
+        package["mod.json"] = entry.json;
+        if (entry.details) {
+            package["about.md"] = *entry.details;
+        }
+        packages.push(std::move(package));
+    }
+    std::erase_if(m_entries, [](auto const& item) { return !item.second.used; });
+    m_dirty = false;
+
+    auto json = matjson::Value::object();
+    json["version"] = INDEX_VERSION;
+    json["packages"] = std::move(packages);
+    return file::writeStringSafe(ModMetadataIndex::getPath(), json.dump(matjson::NO_INDENTATION));
+}
+
 ModMetadata ModMetadata::create(ModJson const& json) {
     return Impl::parse(json, std::nullopt);
 }
@@ -899,6 +1159,8 @@ Result<> ModMetadata::addSpecialFiles(utils::file::Unzip& zip) {
 }
 
 std::vector<std::pair<std::string, std::optional<std::string>*>> ModMetadata::getSpecialFiles() {
+    // the pointers are to the loaded values, not what's still in the package
+    m_impl->loadPendingSpecialFiles();
     return m_impl->getSpecialFiles();
 }
 
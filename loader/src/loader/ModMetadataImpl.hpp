@@ -7,6 +7,7 @@
 #include <Geode/utils/StringMap.hpp>
 #include <Geode/loader/Setting.hpp>
 #include <compare>
+#include <mutex>
 
 using namespace geode::prelude;
 
@@ -106,6 +107,11 @@ namespace geode {
         std::vector<std::string> m_errors;
         bool m_completelyUnparseable = false;
         ModJson m_rawJSON;
+        // Set for metadata that came from the index, whose changelog and
+        // support info are only read out of the package once someone asks
+        // for them. The details are kept in the index, since searching the
+        // installed mods goes through every mod's details
+        mutable bool m_specialFilesPending = false;
 
         ModJson toJSON() const;
         ModJson getRawJSON() const;
@@ -122,9 +128,10 @@ namespace geode {
         );
 
         Result<> addSpecialFiles(std::filesystem::path const& dir);
-        Result<> addSpecialFiles(utils::file::Unzip& zip);
+        Result<> addSpecialFiles(utils::file::Unzip& zip, bool includeDetails = true);
 
         std::vector<std::pair<std::string, std::optional<std::string>*>> getSpecialFiles();
+        void loadPendingSpecialFiles() const;
     };
 
     class ModMetadataImpl : public ModMetadata::Impl {
@@ -132,4 +139,38 @@ namespace geode {
         static ModMetadata::Impl& getImpl(ModMetadata& info);
         static ModMetadata::Impl const& getImpl(ModMetadata const& info);
     };
+
+    // The mod.json of every installed package, kept between launches so
+    // unchanged packages don't have to be opened and parsed again. Entries
+    // are keyed by path and used if the size and modification time still
+    // match, or failing that, a checksum of the package's central directory
+    class ModMetadataIndex final {
+    public:
+        // Reads the index from disk, an unreadable index is just empty
+        ModMetadataIndex();
+
+        static std::filesystem::path getPath();
+
+        // Like ModMetadata::createFromGeodeFile, but served from the index
+        // if the package hasn't changed. Safe to call from many threads
+        ModMetadata get(std::filesystem::path const& path);
+
+        // Writes the index if anything changed, leaving out every package
+        // that wasn't asked for since it was read
+        Result<> save();
+
+    private:
+        struct Entry {
+            uintmax_t size = 0;
+            int64_t modified = 0;
+            std::string checksum;
+            matjson::Value json;
+            std::optional<std::string> details;
+            bool used = false;
+        };
+
+        std::mutex m_mutex;
+        StringMap<Entry> m_entries;
+        bool m_dirty = false;
+    };
 }
@@ -1,8 +1,51 @@
 #include <Geode/loader/Signal.hpp>
+#include <algorithm>
+#include <unordered_map>
 
 namespace geode::comm {
 	thread_local std::vector<ObserverContext> ObserverContext::stack;
 
+	namespace {
+		struct PendingObserver {
+			size_t rank;
+			size_t order;
+			ObserverContext context;
+
+			// std heaps are max heaps, so this puts the lowest rank on top
+			bool operator<(PendingObserver const& other) const noexcept {
+				if (rank != other.rank) return rank > other.rank;
+				return order > other.order;
+			}
+		};
+
+		struct BatchState {
+			size_t depth = 0;
+			size_t nextOrder = 0;
+			std::vector<PendingObserver> pending;
+			// Depth of each signal in the observer graph, one more than the
+			// observer that last set it. Only needed to order the observers of
+			// this batch, so it's only filled while one is open and cleared
+			// when it closes. Signals never set by an observer have no entry
+			std::unordered_map<SignalInternal const*, size_t> ranks;
+		};
+
+		thread_local BatchState s_batch;
+
+		// Guards against observers that keep setting each other's signals
+		constexpr size_t MAX_BATCH_RUNS = 100000;
+
+		void raiseTo(std::atomic_size_t& value, size_t target) noexcept {
+			auto current = value.load(std::memory_order_relaxed);
+			while (current < target && !value.compare_exchange_weak(current, target, std::memory_order_relaxed)) {}
+		}
+	}
+
+	void forgetSignalRank(SignalInternal const* sig) noexcept {
+		if (s_batch.depth > 0) {
+			s_batch.ranks.erase(sig);
+		}
+	}
+
 	ObserverContext* ObserverContext::top() noexcept {
 		if (ObserverContext::stack.empty())
 			return nullptr;
@@ -10,6 +53,16 @@ namespace geode::comm {
 	}
 
 	void ObserverContext::operator()() const noexcept {
+		if (s_batch.depth == 0 || impl->immediate) {
+			return this->run();
+		}
+		if (!impl->queued.exchange(true)) {
+			s_batch.pending.push_back({impl->rank.load(std::memory_order_relaxed), s_batch.nextOrder++, *this});
+			std::push_heap(s_batch.pending.begin(), s_batch.pending.end());
+		}
+	}
+
+	void ObserverContext::run() const noexcept {
 		impl->clearSignals();
 
 		ObserverContext::stack.push_back(*this);
@@ -17,7 +70,23 @@ namespace geode::comm {
 		ObserverContext::stack.pop_back();
 	}
 
+	void ObserverContext::signalChanged(SignalInternal& sig) noexcept {
+		// a signal set by an observer has to be read after that observer ran
+		if (s_batch.depth == 0) return;
+		if (auto observer = ObserverContext::top()) {
+			auto& rank = s_batch.ranks[&sig];
+			rank = std::max(rank, observer->impl->rank.load(std::memory_order_relaxed) + 1);
+		}
+	}
+
 	void ObserverContext::registerSignal(std::shared_ptr<SignalInternal> sig) noexcept {
+		if (s_batch.depth > 0) {
+			auto it = s_batch.ranks.find(sig.get());
+			if (it != s_batch.ranks.end()) {
+				raiseTo(impl->rank, it->second);
+			}
+		}
+
 		for (auto& [s, _] : impl->registered) {
 			if (!s.owner_before(sig) && !sig.owner_before(s))
 				return;
@@ -37,4 +106,43 @@ namespace geode::comm {
 
 	ObserverContext::ObserverContext(geode::Function<void()> eff, std::monostate) noexcept
 		: impl(std::make_shared<ObserverContext::Impl>(std::move(eff))) {}
+
+	SignalBatch::SignalBatch() noexcept {
+		s_batch.depth += 1;
+	}
+
+	SignalBatch::~SignalBatch() noexcept {
+		if (s_batch.depth > 1) {
+			s_batch.depth -= 1;
+			return;
+		}
+
+		// the batch stays open while committing, so signals set by the observers
+		// queue their own observers instead of running them halfway through
+		size_t runs = 0;
+		while (!s_batch.pending.empty()) {
+			if (++runs > MAX_BATCH_RUNS) {
+				geode::log::warn("Signal batch did not settle, observers might be setting each other's signals in a loop");
+				for (auto& pending : s_batch.pending) {
+					pending.context.impl->queued = false;
+				}
+				s_batch.pending.clear();
+				break;
+			}
+
+			std::pop_heap(s_batch.pending.begin(), s_batch.pending.end());
+			auto next = std::move(s_batch.pending.back());
+			s_batch.pending.pop_back();
+
+			next.context.impl->queued = false;
+			next.context.run();
+		}
+		s_batch.depth = 0;
+		s_batch.nextOrder = 0;
+		s_batch.ranks.clear();
+	}
+
+	bool SignalBatch::active() noexcept {
+		return s_batch.depth > 0;
+	}
 }
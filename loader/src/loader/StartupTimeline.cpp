@@ -0,0 +1,203 @@
+#include "StartupTimelineImpl.hpp"
+#include <Geode/loader/Dirs.hpp>
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/file.hpp>
+#include <Geode/utils/general.hpp>
+#include <Geode/utils/timer.hpp>
+#include <matjson.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <optional>
+
+using namespace geode::prelude;
+
+namespace {
+    struct Timeline {
+        std::atomic_bool complete = false;
+
+        std::mutex mutex;
+        std::vector<startup::Span> spans;
+        std::optional<int64_t> first;
+        int64_t end = 0;
+
+        // Never destroyed, blocking threads may still be unzipping while
+        // the game exits
+        static Timeline& get() {
+            static auto s_instance = new Timeline();
+            return *s_instance;
+        }
+    };
+
+    utils::profiler::ZoneID zoneOf(startup::Phase phase) {
+        static auto s_zones = [] {
+            std::array<utils::profiler::ZoneID, static_cast<size_t>(startup::Phase::UpdateResources) + 1> zones;
+            for (size_t i = 0; i < zones.size(); ++i) {
+                zones[i] = utils::profiler::internZone(
+                    fmt::format("startup: {}", startup::phaseName(static_cast<startup::Phase>(i)))
+                );
+            }
+            return zones;
+        }();
+        return s_zones[static_cast<size_t>(phase)];
+    }
+
+    std::string exportTrace(std::vector<startup::Span> const& spans) {
+        // spans only know their thread by name, give each one a tid
+        std::vector<std::string_view> threads;
+        auto tidOf = [&](std::string_view thread) {
+            auto it = std::find(threads.begin(), threads.end(), thread);
+            if (it == threads.end()) {
+                threads.push_back(thread);
+                return threads.size() - 1;
+            }
+            return static_cast<size_t>(it - threads.begin());
+        };
+
+        auto events = matjson::Value::array();
+        for (auto& span : spans) {
+            auto args = matjson::Value::object();
+            if (!span.mod.empty()) {
+                args["mod"] = span.mod;
+            }
+
+            auto event = matjson::Value::object();
+            event["name"] = span.mod.empty()
+                ? std::string(startup::phaseName(span.phase))
+                : fmt::format("{} {}", startup::phaseName(span.phase), span.mod);
+            event["cat"] = std::string(startup::phaseName(span.phase));
+            event["ph"] = "X";
+            event["pid"] = 1;
+            event["tid"] = tidOf(span.thread);
+            event["ts"] = span.start.count() / 1000.0;
+            event["dur"] = span.duration.count() / 1000.0;
+            event["args"] = std::move(args);
+            events.push(std::move(event));
+        }
+        for (size_t tid = 0; tid < threads.size(); ++tid) {
+            auto event = matjson::Value::object();
+            event["name"] = "thread_name";
+            event["ph"] = "M";
+            event["pid"] = 1;
+            event["tid"] = tid;
+            event["args"] = matjson::makeObject({
+                { "name", threads[tid].empty() ? fmt::format("Thread {}", tid) : std::string(threads[tid]) }
+            });
+            events.push(std::move(event));
+        }
+
+        auto json = matjson::Value::object();
+        json["displayTimeUnit"] = "ms";
+        json["traceEvents"] = std::move(events);
+        return json.dump(matjson::NO_INDENTATION);
+    }
+}
+
+std::string_view startup::phaseName(Phase phase) noexcept {
+    switch (phase) {
+        case Phase::QueueMods: return "Queue mods";
+        case Phase::ParseMetadata: return "Parse metadata";
+        case Phase::BuildModGraph: return "Build mod graph";
+        case Phase::Unzip: return "Unzip";
+        case Phase::LoadBinary: return "Load binary";
+        case Phase::LoadHooks: return "Load hooks";
+        case Phase::LoadedHandlers: return "Loaded handlers";
+        case Phase::UpdateResources: return "Update resources";
+    }
+    return "Unknown";
+}
+
+std::vector<startup::Span> startup::getTimeline() {
+    auto& t = Timeline::get();
+    std::lock_guard lock(t.mutex);
+    auto spans = t.spans;
+    std::stable_sort(spans.begin(), spans.end(), [](auto const& a, auto const& b) {
+        return a.start < b.start;
+    });
+    return spans;
+}
+
+std::chrono::nanoseconds startup::getPhaseTime(Phase phase, std::string_view mod) {
+    auto& t = Timeline::get();
+    std::lock_guard lock(t.mutex);
+    std::chrono::nanoseconds total{0};
+    for (auto& span : t.spans) {
+        if (span.phase == phase && (mod.empty() || span.mod == mod)) {
+            total += span.duration;
+        }
+    }
+    return total;
+}
+
+bool startup::isComplete() noexcept {
+    return Timeline::get().complete.load(std::memory_order_acquire);
+}
+
+std::chrono::nanoseconds startup::getTotalTime() {
+    auto& t = Timeline::get();
+    std::lock_guard lock(t.mutex);
+    if (!t.first) return std::chrono::nanoseconds(0);
+    auto end = t.complete.load(std::memory_order_relaxed) ? t.end : utils::profiler::now();
+    return std::chrono::nanoseconds(end - *t.first);
+}
+
+std::filesystem::path startup::getTracePath() {
+    return dirs::getGeodeLogDir() / "startup-trace.json";
+}
+
+startup::ScopedSpan::ScopedSpan(Phase phase, std::string_view mod)
+  : m_phase(phase), m_mod(mod), m_start(utils::profiler::now()), m_active(!startup::isComplete()) {}
+
+startup::ScopedSpan::~ScopedSpan() {
+    if (!m_active) return;
+    auto end = utils::profiler::now();
+
+    if (utils::profiler::isEnabled()) {
+        utils::profiler::record(zoneOf(m_phase), m_start, end);
+    }
+
+    auto& t = Timeline::get();
+    std::lock_guard lock(t.mutex);
+    // startup may have finished while this was running, which would make
+    // the span outlast the trace that's already been written
+    if (t.complete.load(std::memory_order_relaxed)) return;
+    if (!t.first || m_start < *t.first) {
+        t.first = m_start;
+    }
+    t.spans.push_back({
+        m_phase,
+        std::move(m_mod),
+        std::string(utils::thread::getName().view()),
+        std::chrono::nanoseconds(m_start),
+        std::chrono::nanoseconds(end - m_start),
+    });
+}
+
+void startup::ScopedSpan::setMod(std::string_view mod) {
+    m_mod = mod;
+}
+
+void startup::finish() {
+    auto& t = Timeline::get();
+    std::vector<Span> spans;
+    {
+        std::lock_guard lock(t.mutex);
+        if (t.complete.exchange(true, std::memory_order_acq_rel)) return;
+        t.end = utils::profiler::now();
+        spans = t.spans;
+    }
+    std::stable_sort(spans.begin(), spans.end(), [](auto const& a, auto const& b) {
+        return a.start < b.start;
+    });
+
+    if (auto res = file::writeString(startup::getTracePath(), exportTrace(spans)); !res) {
+        log::warn("Failed to write startup trace: {}", res.unwrapErr());
+        return;
+    }
+    log::info(
+        "Startup took {}s over {} spans, trace written to {}",
+        static_cast<float>(startup::getTotalTime().count()) / 1e9f, spans.size(), startup::getTracePath()
+    );
+}
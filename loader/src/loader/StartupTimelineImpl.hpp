@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Geode/loader/StartupTimeline.hpp>
+
+namespace geode::startup {
+    // Records a span for as long as it's alive, unless startup has
+    // already finished by the time it started
+    class ScopedSpan {
+        Phase m_phase;
+        std::string m_mod;
+        int64_t m_start;
+        bool m_active;
+    public:
+        ScopedSpan(Phase phase, std::string_view mod = {});
+        ~ScopedSpan();
+        ScopedSpan(ScopedSpan const&) = delete;
+        ScopedSpan& operator=(ScopedSpan const&) = delete;
+
+        // For spans that only learn which mod they're about partway in
+        void setMod(std::string_view mod);
+    };
+
+    // Freezes the timeline and writes the trace file, only the first call
+    // does anything
+    void finish();
+}
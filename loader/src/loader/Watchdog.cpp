@@ -0,0 +1,243 @@
+#include <Geode/loader/Watchdog.hpp>
+#include <Geode/loader/Log.hpp>
+#include <Geode/loader/Mod.hpp>
+#include "WatchdogImpl.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#ifndef GEODE_IS_WINDOWS
+#include <cxxabi.h>
+#endif
+
+using namespace geode::prelude;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t MAX_REPORTS = 32;
+    constexpr size_t MAX_REPORT_ENTRIES = 8;
+    // keeps a frame with thousands of distinct event types from growing
+    // the list without bound, the rest is lumped together
+    constexpr size_t MAX_FRAME_ENTRIES = 64;
+    constexpr auto LOG_INTERVAL = std::chrono::seconds(5);
+
+    struct OpenScope {
+        Mod* mod;
+        char const* label;
+        bool isTypeName;
+        Clock::time_point start;
+        Clock::duration children{0};
+    };
+
+    struct FrameEntry {
+        Mod* mod;
+        char const* label;
+        bool isTypeName;
+        Clock::duration time{0};
+        size_t calls = 0;
+    };
+
+    // Everything but the reports is only touched on the main thread
+    struct Watchdog {
+        std::atomic<std::chrono::milliseconds> threshold = std::chrono::milliseconds(50);
+
+        std::vector<OpenScope> stack;
+        std::vector<FrameEntry> entries;
+        // scopes that didn't fit in entries, kept apart so no real entry
+        // gets relabeled and loses the time it already had
+        FrameEntry overflow{ nullptr, "other", false };
+        std::optional<Clock::time_point> frameStart;
+        size_t frame = 0;
+
+        Clock::time_point lastLog;
+        size_t unloggedHitches = 0;
+
+        std::mutex reportsMutex;
+        std::deque<watchdog::HitchReport> reports;
+
+        static Watchdog& get() {
+            static auto s_instance = new Watchdog();
+            return *s_instance;
+        }
+    };
+
+    thread_local bool s_isMainThread = false;
+
+    std::string demangle(char const* name) {
+    #ifdef GEODE_IS_WINDOWS
+        std::string_view tname = name;
+        if (tname.starts_with("class ")) {
+            tname.remove_prefix(6);
+        } else if (tname.starts_with("struct ")) {
+            tname.remove_prefix(7);
+        }
+        return std::string(tname);
+    #else
+        std::string ret = name;
+        int status = 0;
+        auto demangled = abi::__cxa_demangle(name, 0, 0, &status);
+        if (status == 0) {
+            ret = demangled;
+        }
+        free(demangled);
+        return ret;
+    #endif
+    }
+
+    std::string modName(Mod* mod) {
+        return mod ? std::string(mod->getID().view()) : "<unknown>";
+    }
+
+    void logReport(watchdog::HitchReport const& report, size_t skipped) {
+        std::string top;
+        for (auto& entry : report.entries) {
+            if (!top.empty()) top += ", ";
+            top += fmt::format("{} ({}) {}ms", modName(entry.mod), entry.label, entry.time.count() / 1000.0);
+        }
+        log::warn(
+            "Frame took {}ms ({}ms attributed){}: {}",
+            report.frameTime.count() / 1000.0, report.attributedTime.count() / 1000.0,
+            skipped ? fmt::format(", {} more hitches since last report", skipped) : "",
+            top.empty() ? "nothing attributed" : top
+        );
+    }
+}
+
+std::atomic_bool watchdog::detail::enabled = false;
+
+bool watchdog::detail::isMainThread() noexcept {
+    return s_isMainThread;
+}
+
+void watchdog::setEnabled(bool enabled) {
+    detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void watchdog::setThreshold(std::chrono::milliseconds threshold) {
+    Watchdog::get().threshold.store(threshold, std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds watchdog::getThreshold() noexcept {
+    return Watchdog::get().threshold.load(std::memory_order_relaxed);
+}
+
+std::vector<watchdog::HitchReport> watchdog::getReports() {
+    auto& w = Watchdog::get();
+    std::lock_guard lock(w.reportsMutex);
+    return { w.reports.begin(), w.reports.end() };
+}
+
+void watchdog::clearReports() {
+    auto& w = Watchdog::get();
+    std::lock_guard lock(w.reportsMutex);
+    w.reports.clear();
+}
+
+void watchdog::beginScope(Mod* mod, char const* label, bool isTypeName) noexcept {
+    if (!s_isMainThread) return;
+    auto& w = Watchdog::get();
+    if (!label && !w.stack.empty()) {
+        label = w.stack.back().label;
+        isTypeName = w.stack.back().isTypeName;
+    }
+    else if (!label) {
+        label = "<unknown>";
+        isTypeName = false;
+    }
+    w.stack.push_back({ mod, label, isTypeName, Clock::now() });
+}
+
+void watchdog::endScope() noexcept {
+    if (!s_isMainThread) return;
+    auto& w = Watchdog::get();
+    // the watchdog may have been enabled while this scope was open
+    if (w.stack.empty()) return;
+
+    auto scope = w.stack.back();
+    w.stack.pop_back();
+
+    auto total = Clock::now() - scope.start;
+    if (!w.stack.empty()) {
+        w.stack.back().children += total;
+    }
+
+    auto it = std::find_if(w.entries.begin(), w.entries.end(), [&](FrameEntry const& entry) {
+        return entry.mod == scope.mod && entry.label == scope.label;
+    });
+    FrameEntry* entry = &w.overflow;
+    if (it != w.entries.end()) {
+        entry = &*it;
+    }
+    else if (w.entries.size() < MAX_FRAME_ENTRIES) {
+        entry = &w.entries.emplace_back(FrameEntry{ scope.mod, scope.label, scope.isTypeName });
+    }
+    entry->time += total - scope.children;
+    entry->calls += 1;
+}
+
+void watchdog::onFrame() {
+    s_isMainThread = true;
+
+    auto& w = Watchdog::get();
+    if (!watchdog::isEnabled()) {
+        w.frameStart.reset();
+        w.entries.clear();
+        w.overflow.time = Clock::duration(0);
+        w.overflow.calls = 0;
+        return;
+    }
+
+    auto now = Clock::now();
+    auto start = std::exchange(w.frameStart, now);
+    w.frame += 1;
+    if (!start) return;
+
+    auto frameTime = now - *start;
+    if (frameTime > w.threshold.load(std::memory_order_relaxed)) {
+        watchdog::HitchReport report;
+        report.frame = w.frame;
+        report.when = std::chrono::system_clock::now();
+        report.frameTime = std::chrono::duration_cast<std::chrono::microseconds>(frameTime);
+
+        if (w.overflow.calls > 0) {
+            w.entries.push_back(w.overflow);
+        }
+        std::sort(w.entries.begin(), w.entries.end(), [](auto const& a, auto const& b) {
+            return a.time > b.time;
+        });
+        for (auto& entry : w.entries) {
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(entry.time);
+            report.attributedTime += time;
+            if (report.entries.size() < MAX_REPORT_ENTRIES) {
+                report.entries.push_back({
+                    entry.mod,
+                    entry.isTypeName ? demangle(entry.label) : std::string(entry.label),
+                    time, entry.calls
+                });
+            }
+        }
+
+        if (now - w.lastLog >= LOG_INTERVAL) {
+            logReport(report, w.unloggedHitches);
+            w.lastLog = now;
+            w.unloggedHitches = 0;
+        }
+        else {
+            w.unloggedHitches += 1;
+        }
+
+        std::lock_guard lock(w.reportsMutex);
+        if (w.reports.size() >= MAX_REPORTS) {
+            w.reports.pop_front();
+        }
+        w.reports.push_back(std::move(report));
+    }
+    w.entries.clear();
+    w.overflow.time = Clock::duration(0);
+    w.overflow.calls = 0;
+}
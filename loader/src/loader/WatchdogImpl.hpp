@@ -0,0 +1,8 @@
+#pragma once
+
+#include <Geode/loader/Watchdog.hpp>
+
+namespace geode::watchdog {
+    // Called at the start of every frame on the main thread
+    void onFrame();
+}
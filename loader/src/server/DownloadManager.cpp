@@ -20,7 +20,6 @@ public:
     DownloadStatus m_status;
     async::TaskHolder<web::WebResponse> m_downloadListener;
     async::TaskHolder<ServerResult<ServerModVersion>> m_infoListener;
-    unsigned int m_scheduledEventForFrame = 0;
 
     Impl(
         std::string id,
@@ -66,13 +65,13 @@ public:
 
                 Loader::get()->queueInMainThread([id = m_id]() {
                     ModDownloadEvent(std::string(id)).send();
-                });
+                }, MainThreadPriority::Normal);
             }
         );
 
         Loader::get()->queueInMainThread([id = m_id] {
             ModDownloadEvent(std::string(id)).send();
-        });
+        }, MainThreadPriority::Normal);
     }
 
     void onFinished(web::WebResponse response, ServerModVersion version) {
@@ -178,19 +177,20 @@ public:
             [this, version = std::move(version)](web::WebResponse response) mutable {
                 this->onFinished(std::move(response), std::move(version));
 
-                // post event
-                if (m_scheduledEventForFrame != CCDirector::get()->getTotalFrames()) {
-                    m_scheduledEventForFrame = CCDirector::get()->getTotalFrames();
-                    Loader::get()->queueInMainThread([id = m_id]() {
+                // post event, at most once per frame
+                Loader::get()->queueInMainThreadCoalesced(
+                    fmt::format("geode.loader/mod-download:{}", m_id),
+                    [id = m_id]() {
                         ModDownloadEvent(std::string(id)).send();
-                    });
-                }
+                    },
+                    MainThreadPriority::Normal
+                );
             }
         );
 
         Loader::get()->queueInMainThread([id = m_id]() {
             ModDownloadEvent(std::string(id)).send();
-        });
+        }, MainThreadPriority::Normal);
     }
 };
 
@@ -166,6 +166,8 @@ void BaseSettingsPopup::onResetAll(CCObject*) {
         "Cancel", "Reset",
         [this](auto, bool btn2) {
             if (btn2) {
+                // observers of several settings should only react once
+                geode::comm::SignalBatch batch;
                 for (auto& sett : m_settings) {
                     sett->resetToDefault();
                 }
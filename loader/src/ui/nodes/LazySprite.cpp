@@ -190,6 +190,7 @@ void LazySprite::Impl::doInitFromBytes(std::vector<uint8_t> data, std::string ca
 
         // image initialization succeeded, all we need to do now is to
         // create the OpenGL texture (must be on main thread!) and then set this sprite to use that.
+        // uploads are slow, so a page of them gets spread over a few frames
 
         Loader::get()->queueInMainThread([
             selfref = std::move(selfref),
@@ -221,7 +222,7 @@ void LazySprite::Impl::doInitFromBytes(std::vector<uint8_t> data, std::string ca
             }
 
             texture->release(); // bring texture's refcount back to 1
-        });
+        }, MainThreadPriority::Low);
     });
 }
 
@@ -0,0 +1,22 @@
+#include <Geode/utils/FramePool.hpp>
+#include "FramePoolBlocks.hpp"
+
+using namespace geode::utils;
+
+void* frame_pool::allocate(size_t size) {
+    return blocks::allocate(size);
+}
+
+void frame_pool::deallocate(void* ptr, size_t size) noexcept {
+    blocks::deallocate(ptr, size);
+}
+
+FramePoolStats frame_pool::stats() noexcept {
+    auto counters = blocks::counters();
+    return FramePoolStats {
+        .allocations = counters.allocations,
+        .reused = counters.reused,
+        .oversized = counters.oversized,
+        .live = counters.live,
+    };
+}
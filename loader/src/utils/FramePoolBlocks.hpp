@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+
+// The size-class free lists behind utils::frame_pool. Only uses the standard
+// library, so that it can be tested on the host (see test/host)
+namespace geode::utils::frame_pool::blocks {
+    constexpr size_t MIN_CLASS_SHIFT = 6; // 64 bytes
+    constexpr size_t CLASS_COUNT = 7;     // up to 4 KiB
+    constexpr size_t MAX_BLOCK_SIZE = size_t(1) << (MIN_CLASS_SHIFT + CLASS_COUNT - 1);
+    // Blocks a thread keeps for itself per class, past that they're handed
+    // to the shared list for other threads to pick up
+    constexpr size_t THREAD_CACHE_LIMIT = 128;
+
+    struct Counters {
+        size_t allocations = 0;
+        size_t reused = 0;
+        size_t oversized = 0;
+        size_t live = 0;
+    };
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    inline size_t classOf(size_t size) noexcept {
+        if (size <= (size_t(1) << MIN_CLASS_SHIFT)) return 0;
+        return std::bit_width(size - 1) - MIN_CLASS_SHIFT;
+    }
+
+    inline size_t classSize(size_t cls) noexcept {
+        return size_t(1) << (cls + MIN_CLASS_SHIFT);
+    }
+
+    struct Shared {
+        // Only ever pushed onto one block at a time, and taken as a whole
+        // with an exchange, so there's no ABA problem
+        std::array<std::atomic<FreeBlock*>, CLASS_COUNT> lists {};
+
+        std::atomic_size_t allocations = 0;
+        std::atomic_size_t reused = 0;
+        std::atomic_size_t oversized = 0;
+        std::atomic_size_t live = 0;
+
+        void push(size_t cls, FreeBlock* first, FreeBlock* last) noexcept {
+            last->next = lists[cls].load(std::memory_order_relaxed);
+            while (!lists[cls].compare_exchange_weak(
+                last->next, first, std::memory_order_release, std::memory_order_relaxed
+            )) {}
+        }
+
+        // Never destroyed, threads may still give blocks back while exiting
+        static Shared& get() noexcept {
+            static auto s_instance = new Shared();
+            return *s_instance;
+        }
+    };
+
+    struct ThreadCache {
+        std::array<FreeBlock*, CLASS_COUNT> heads {};
+        std::array<size_t, CLASS_COUNT> counts {};
+
+        ~ThreadCache() {
+            // hand everything over, someone else will need it
+            auto& shared = Shared::get();
+            for (size_t cls = 0; cls < CLASS_COUNT; ++cls) {
+                auto first = heads[cls];
+                if (!first) continue;
+                auto last = first;
+                while (last->next) last = last->next;
+                shared.push(cls, first, last);
+            }
+        }
+
+        static ThreadCache& get() noexcept {
+            static thread_local ThreadCache s_cache;
+            return s_cache;
+        }
+    };
+
+    inline void* allocate(size_t size) {
+        auto& shared = Shared::get();
+        shared.allocations.fetch_add(1, std::memory_order_relaxed);
+        shared.live.fetch_add(1, std::memory_order_relaxed);
+
+        if (size > MAX_BLOCK_SIZE) {
+            shared.oversized.fetch_add(1, std::memory_order_relaxed);
+            return ::operator new(size);
+        }
+
+        auto cls = classOf(size);
+        auto& cache = ThreadCache::get();
+        if (!cache.heads[cls]) {
+            cache.heads[cls] = shared.lists[cls].exchange(nullptr, std::memory_order_acquire);
+            // the count is only a limit for giving blocks away, it doesn't
+            // need to know how many came in
+            cache.counts[cls] = 0;
+        }
+        if (auto block = cache.heads[cls]) {
+            cache.heads[cls] = block->next;
+            if (cache.counts[cls] > 0) cache.counts[cls] -= 1;
+            shared.reused.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+        return ::operator new(classSize(cls));
+    }
+
+    inline void deallocate(void* ptr, size_t size) noexcept {
+        if (!ptr) return;
+        auto& shared = Shared::get();
+        shared.live.fetch_sub(1, std::memory_order_relaxed);
+
+        if (size > MAX_BLOCK_SIZE) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        auto cls = classOf(size);
+        auto block = static_cast<FreeBlock*>(ptr);
+        auto& cache = ThreadCache::get();
+        if (cache.counts[cls] >= THREAD_CACHE_LIMIT) {
+            shared.push(cls, block, block);
+            return;
+        }
+        block->next = cache.heads[cls];
+        cache.heads[cls] = block;
+        cache.counts[cls] += 1;
+    }
+
+    inline Counters counters() noexcept {
+        auto& shared = Shared::get();
+        return Counters {
+            .allocations = shared.allocations.load(std::memory_order_relaxed),
+            .reused = shared.reused.load(std::memory_order_relaxed),
+            .oversized = shared.oversized.load(std::memory_order_relaxed),
+            .live = shared.live.load(std::memory_order_relaxed),
+        };
+    }
+}
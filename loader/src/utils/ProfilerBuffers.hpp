@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The per-thread zone buffers behind utils::profiler. Only uses the standard
+// library, so that it can be tested on the host (see test/host)
+namespace geode::utils::profiler {
+    using ZoneID = uint32_t;
+
+    class ZoneBuffers final {
+    public:
+        static constexpr size_t BUFFER_SIZE = 16384;
+
+        // Slots are atomics so that collecting while the owning thread keeps
+        // recording is well defined, and work like a seqlock: a reader discards
+        // any slot a write was started on while it was being copied
+        struct Slot {
+            std::atomic<ZoneID> zone = 0;
+            std::atomic<int64_t> start = 0;
+            std::atomic<int64_t> end = 0;
+        };
+
+        struct ThreadBuffer {
+            uint32_t thread;
+            std::string name;
+            // Only written by the owning thread. Writes are claimed before the
+            // slot is written and published after
+            std::atomic_size_t claimed = 0;
+            std::atomic_size_t head = 0;
+            // Everything before this was cleared
+            std::atomic_size_t tail = 0;
+            // Set when the owning thread exits, after its last write
+            std::atomic_bool exited = false;
+            std::array<Slot, BUFFER_SIZE> slots;
+
+            void write(ZoneID zone, int64_t start, int64_t end) noexcept {
+                auto current = head.load(std::memory_order_relaxed);
+                auto& slot = slots[current % BUFFER_SIZE];
+                claimed.store(current + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.zone.store(zone, std::memory_order_relaxed);
+                slot.start.store(start, std::memory_order_relaxed);
+                slot.end.store(end, std::memory_order_relaxed);
+                head.store(current + 1, std::memory_order_release);
+            }
+        };
+
+    private:
+        // Plain data, so it stays usable while the thread's other
+        // thread_locals are being destroyed. Zero initialized like any
+        // thread_local
+        struct ThreadState {
+            ThreadBuffer* buffer;
+            bool exited;
+        };
+        static inline thread_local ThreadState s_state;
+
+        struct ThreadExit {
+            ~ThreadExit() {
+                if (s_state.buffer) {
+                    s_state.buffer->exited.store(true, std::memory_order_release);
+                }
+                s_state = { nullptr, true };
+            }
+        };
+
+        std::string (*m_threadName)();
+        std::mutex m_mutex;
+        // Exited threads' buffers are kept until the next clear, so their
+        // zones can still be collected
+        std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+        uint32_t m_nextThread = 0;
+
+    public:
+        // There's only meant to be one of these, the current thread's buffer
+        // isn't tracked per instance
+        explicit ZoneBuffers(std::string (*threadName)()) : m_threadName(threadName) {}
+
+        /**
+         * The current thread's buffer. A thread only gets one once it records
+         * with `allocate` set, so threads that never record while profiling
+         * don't hold on to one. Null if the thread has no buffer, or is exiting
+         */
+        ThreadBuffer* current(bool allocate) {
+            if (s_state.buffer || s_state.exited || !allocate) {
+                return s_state.buffer;
+            }
+            static thread_local ThreadExit s_exit;
+            (void)s_exit;
+
+            auto buffer = std::make_shared<ThreadBuffer>();
+            buffer->name = m_threadName ? m_threadName() : std::string();
+            std::lock_guard lock(m_mutex);
+            buffer->thread = m_nextThread++;
+            m_buffers.push_back(buffer);
+            s_state.buffer = buffer.get();
+            return s_state.buffer;
+        }
+
+        /// Every thread's zones, ordered by start time
+        template <class Record>
+        std::vector<Record> collect() {
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            {
+                std::lock_guard lock(m_mutex);
+                buffers = m_buffers;
+            }
+
+            std::vector<Record> records;
+            for (auto& buffer : buffers) {
+                auto head = buffer->head.load(std::memory_order_acquire);
+                auto first = std::max(buffer->tail.load(std::memory_order_relaxed), head > BUFFER_SIZE ? head - BUFFER_SIZE : 0);
+                auto offset = records.size();
+                for (auto i = first; i < head; ++i) {
+                    auto& slot = buffer->slots[i % BUFFER_SIZE];
+                    records.push_back({
+                        slot.zone.load(std::memory_order_relaxed),
+                        buffer->thread,
+                        slot.start.load(std::memory_order_relaxed),
+                        slot.end.load(std::memory_order_relaxed),
+                    });
+                }
+                // Slots the thread started overwriting while we were copying may be torn
+                std::atomic_thread_fence(std::memory_order_acquire);
+                auto claimed = buffer->claimed.load(std::memory_order_relaxed);
+                if (claimed > first + BUFFER_SIZE) {
+                    auto torn = std::min(claimed - BUFFER_SIZE - first, head - first);
+                    records.erase(records.begin() + offset, records.begin() + offset + torn);
+                }
+            }
+
+            std::sort(records.begin(), records.end(), [](auto const& a, auto const& b) {
+                return a.start < b.start;
+            });
+            return records;
+        }
+
+        /// Drop every recorded zone, and the buffers of threads that have exited
+        void clear() {
+            std::lock_guard lock(m_mutex);
+            std::erase_if(m_buffers, [](auto const& buffer) {
+                return buffer->exited.load(std::memory_order_acquire);
+            });
+            for (auto& buffer : m_buffers) {
+                buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+            }
+        }
+
+        /// Call `func(thread, name)` for every thread that has a buffer
+        template <class F>
+        void forEachThread(F&& func) {
+            std::lock_guard lock(m_mutex);
+            for (auto& buffer : m_buffers) {
+                func(buffer->thread, buffer->name);
+            }
+        }
+
+        size_t threadCount() {
+            std::lock_guard lock(m_mutex);
+            return m_buffers.size();
+        }
+    };
+}
@@ -1,16 +1,84 @@
 #include <Geode/utils/async.hpp>
 #include <Geode/loader/GameEvent.hpp>
 #include <Geode/loader/Log.hpp>
+#include <Geode/loader/Mod.hpp>
+#include <Geode/utils/general.hpp>
 #include <Geode/utils/terminate.hpp>
 #include <loader/LogImpl.hpp>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
 
 using namespace geode::prelude;
 
 namespace geode::async {
 
+namespace {
+    struct WorkerSlot {
+        std::atomic<int64_t> busyNs = 0;
+        std::atomic_size_t polls = 0;
+        std::chrono::steady_clock::time_point firstPoll = std::chrono::steady_clock::now();
+    };
+
+    struct TaskStats {
+        std::atomic_size_t spawned = 0;
+        std::atomic_size_t started = 0;
+        std::atomic_size_t finished = 0;
+        std::mutex workersMutex;
+        // slots live forever, so threads can keep a plain pointer to theirs
+        std::vector<std::unique_ptr<WorkerSlot>> workers;
+
+        static TaskStats& get() {
+            static auto s_instance = new TaskStats();
+            return *s_instance;
+        }
+    };
+
+    std::atomic_size_t s_workerCount = 0;
+
+    std::optional<size_t> countFromLaunchArgument(std::string_view name) {
+        auto arg = Loader::get()->getLaunchArgument(name);
+        if (!arg) {
+            return std::nullopt;
+        }
+        auto count = numFromString<size_t>(*arg);
+        if (count && count.unwrap() > 0) {
+            return std::min<size_t>(count.unwrap(), 64);
+        }
+        log::warn("Invalid {} launch argument '{}', ignoring", name, *arg);
+        return std::nullopt;
+    }
+
+    size_t pickWorkerCount() {
+        if (auto count = countFromLaunchArgument("async-workers")) {
+            return *count;
+        }
+
+        if (auto setting = Mod::get()->getSettingValue<int>("async-worker-threads"); setting > 0) {
+            return static_cast<size_t>(setting);
+        }
+
+        auto cores = std::thread::hardware_concurrency();
+        if (cores == 0) {
+            return 4;
+        }
+        // leave a core for the main thread, which also renders, but keep a
+        // couple of workers so one slow task can't hold up everything else
+        return std::clamp<size_t>(cores - 1, 2, 16);
+    }
+}
+
 asp::SharedPtr<arc::Runtime>& runtimePtr() {
     static auto runtime = []{
-        auto rt = arc::Runtime::create(4);
+        auto workers = pickWorkerCount();
+        s_workerCount.store(workers, std::memory_order_relaxed);
+        log::debug("Starting async runtime with {} workers", workers);
+
+        auto rt = arc::Runtime::create(workers);
         rt->setTerminateHandler([](const std::exception& e) {
             utils::terminate(fmt::format(
                 "arc runtime terminated due to unhandled exception: {}",
@@ -28,6 +96,63 @@ arc::Runtime& runtime() {
     return *runtimePtr();
 }
 
+size_t workerCount() {
+    // make sure the runtime exists, so the count has been picked
+    (void)runtimePtr();
+    return s_workerCount.load(std::memory_order_relaxed);
+}
+
+RuntimeStats runtimeStats() {
+    auto& stats = TaskStats::get();
+    RuntimeStats ret;
+    ret.workerCount = s_workerCount.load(std::memory_order_relaxed);
+
+    // read finished before started before spawned, so that none of the
+    // differences can go negative while tasks are moving along
+    auto finished = stats.finished.load(std::memory_order_acquire);
+    auto started = stats.started.load(std::memory_order_acquire);
+    auto spawned = stats.spawned.load(std::memory_order_acquire);
+    ret.completedTasks = finished;
+    ret.runningTasks = started - finished;
+    ret.queuedTasks = spawned - started;
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock(stats.workersMutex);
+    for (auto& slot : stats.workers) {
+        auto& worker = ret.workers.emplace_back();
+        worker.busyTime = std::chrono::nanoseconds(slot->busyNs.load(std::memory_order_relaxed));
+        worker.polls = slot->polls.load(std::memory_order_relaxed);
+        auto alive = std::chrono::duration_cast<std::chrono::nanoseconds>(now - slot->firstPoll);
+        if (alive.count() > 0) {
+            worker.utilization = std::min(1.0, static_cast<double>(worker.busyTime.count()) / alive.count());
+        }
+    }
+    return ret;
+}
+
+void _detail::taskSpawned() noexcept {
+    TaskStats::get().spawned.fetch_add(1, std::memory_order_release);
+}
+
+void _detail::taskStarted() noexcept {
+    TaskStats::get().started.fetch_add(1, std::memory_order_release);
+}
+
+void _detail::taskFinished() noexcept {
+    TaskStats::get().finished.fetch_add(1, std::memory_order_release);
+}
+
+void _detail::taskPolled(std::chrono::nanoseconds time) noexcept {
+    static thread_local WorkerSlot* s_slot = nullptr;
+    if (!s_slot) {
+        auto& stats = TaskStats::get();
+        std::lock_guard lock(stats.workersMutex);
+        s_slot = stats.workers.emplace_back(std::make_unique<WorkerSlot>()).get();
+    }
+    s_slot->busyNs.fetch_add(time.count(), std::memory_order_relaxed);
+    s_slot->polls.fetch_add(1, std::memory_order_relaxed);
+}
+
 }
 
 $on_mod(Loaded) {
@@ -5,6 +5,7 @@
 #include <Geode/utils/string.hpp>
 #include <matjson.hpp>
 #include <mz.h>
+#include <mz_crypt.h>
 #include <mz_os.h>
 #include <mz_strm.h>
 #include <mz_strm_os.h>
@@ -210,6 +211,18 @@ Result<ByteVector> utils::file::readBinary(std::filesystem::path const& path) {
     return Ok(std::move(contents));
 }
 
+Result<uint32_t> utils::file::readCRC32(std::filesystem::path const& path) {
+    GEODE_UNWRAP_INTO(auto data, utils::file::readBinary(path));
+    uint32_t crc = 0;
+    // mz_crypt_crc32_update only takes an int32 size
+    constexpr size_t CHUNK_SIZE = 1 << 30;
+    for (size_t offset = 0; offset < data.size(); offset += CHUNK_SIZE) {
+        auto size = std::min(CHUNK_SIZE, data.size() - offset);
+        crc = mz_crypt_crc32_update(crc, data.data() + offset, static_cast<int32_t>(size));
+    }
+    return Ok(crc);
+}
+
 Result<> utils::file::writeString(std::filesystem::path const& path, std::string_view data) {
     return writeFileFrom(path, (void*)data.data(), data.size());
 }
@@ -323,6 +336,7 @@ struct ZipEntry {
     bool isDirectory;
     int64_t compressedSize;
     int64_t uncompressedSize;
+    uint32_t crc32;
 };
 
 class Zip::Impl final {
@@ -412,6 +426,7 @@ private:
                 .isDirectory = mz_zip_entry_is_dir(m_handle) == MZ_OK,
                 .compressedSize = info->compressed_size,
                 .uncompressedSize = info->uncompressed_size,
+                .crc32 = info->crc,
             } });
 
             err = mz_zip_goto_next_entry(m_handle);
@@ -580,6 +595,11 @@ public:
             })
         );
 
+        return this->readCurrent(entry.uncompressedSize);
+    }
+
+    // Reads the entry the handle is at
+    Result<ByteVector> readCurrent(int64_t size) {
         GEODE_UNWRAP(
             mzTry(mz_zip_entry_read_open(m_handle, 0, nullptr))
             .mapErr([&](auto error) {
@@ -587,21 +607,62 @@ public:
             })
         );
 
+        ByteVector res;
         // if the file is empty, its data is empty (duh)
-        if (!entry.uncompressedSize) {
-            return Ok(ByteVector());
+        if (size) {
+            res.resize(size);
+            auto read = mz_zip_entry_read(m_handle, res.data(), size);
+            if (read < 0) {
+                mz_zip_entry_close(m_handle);
+                return Err("Unable to read entry (code {})", read);
+            }
         }
+        mz_zip_entry_close(m_handle);
 
-        ByteVector res;
-        res.resize(entry.uncompressedSize);
-        auto read = mz_zip_entry_read(m_handle, res.data(), entry.uncompressedSize);
-        if (read < 0) {
-            mz_zip_entry_close(m_handle);
-            return Err("Unable to read entry (code {})", read);
+        return Ok(std::move(res));
+    }
+
+    Result<> extractEach(geode::Function<std::optional<Path>(Unzip::EntryInfo const&)>& callback) {
+        auto first = mz_zip_goto_first_entry(m_handle);
+        if (first == MZ_END_OF_LIST) {
+            return Ok();
         }
-        mz_zip_entry_close(m_handle);
+        GEODE_UNWRAP(
+            mzTry(first)
+            .mapErr([&](auto error) {
+                return fmt::format("Unable to navigate to first entry (code {})", error);
+            })
+        );
 
-        return Ok(res);
+        do {
+            mz_zip_file* info = nullptr;
+            if (mz_zip_entry_get_info(m_handle, &info) != MZ_OK) {
+                return Err("Unable to get entry info");
+            }
+
+            Unzip::EntryInfo entry;
+            entry.path.assign(info->filename, info->filename + info->filename_size);
+            entry.isDirectory = mz_zip_entry_is_dir(m_handle) == MZ_OK;
+            entry.size = static_cast<uint64_t>(info->uncompressed_size);
+            entry.crc32 = info->crc;
+
+            auto target = callback(entry);
+            if (!target) {
+                continue;
+            }
+
+            GEODE_UNWRAP_INTO(auto bytes, this->readCurrent(info->uncompressed_size).mapErr([&](auto error) {
+                return fmt::format("Unable to extract entry {}: {}", entry.path, error);
+            }));
+            if (target->has_parent_path()) {
+                GEODE_UNWRAP(file::createDirectoryAll(target->parent_path()));
+            }
+            GEODE_UNWRAP(file::writeBinary(*target, bytes).mapErr([&](auto error) {
+                return fmt::format("Unable to write file {}: {}", *target, error);
+            }));
+        } while (mz_zip_goto_next_entry(m_handle) == MZ_OK);
+
+        return Ok();
     }
 
     Result<> addFolder(Path const& path) {
@@ -727,6 +788,19 @@ std::vector<Unzip::Path> Unzip::getEntries() const {
     return map::keys(m_impl->getEntries());
 }
 
+std::vector<Unzip::EntryInfo> Unzip::getEntryInfo() const {
+    std::vector<EntryInfo> res;
+    for (auto& [path, entry] : m_impl->getEntries()) {
+        res.push_back({
+            .path = path,
+            .isDirectory = entry.isDirectory,
+            .size = static_cast<uint64_t>(entry.uncompressedSize),
+            .crc32 = entry.crc32,
+        });
+    }
+    return res;
+}
+
 bool Unzip::hasEntry(Path const& name) {
     return m_impl->getEntries().count(name);
 }
@@ -755,6 +829,10 @@ Result<> Unzip::extractAllTo(Path const& dir) {
     return m_impl->extractAllTo(dir);
 }
 
+Result<> Unzip::extractEach(geode::Function<std::optional<Path>(EntryInfo const&)> callback) {
+    return m_impl->extractEach(callback);
+}
+
 Result<> Unzip::intoDir(
     Path const& from,
     Path const& to,
@@ -0,0 +1,150 @@
+#include <Geode/utils/timer.hpp>
+#include <Geode/utils/file.hpp>
+#include <Geode/utils/general.hpp>
+#include <Geode/utils/StringMap.hpp>
+#include "ProfilerBuffers.hpp"
+
+#include <atomic>
+#include <mutex>
+
+using namespace geode::prelude;
+using namespace geode::utils::profiler;
+
+namespace {
+    struct Profiler {
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+        std::mutex namesMutex;
+        StringMap<ZoneID> ids;
+        std::vector<std::string> names { "<none>" };
+
+        ZoneBuffers buffers { [] { return std::string(utils::thread::getName().view()); } };
+
+        // Never destroyed, threads may still record while exiting
+        static Profiler& get() {
+            static auto s_instance = new Profiler();
+            return *s_instance;
+        }
+    };
+
+    void appendEscaped(std::string& out, std::string_view str) {
+        out += '"';
+        for (char c : str) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out += fmt::format("\\u{:04x}", static_cast<int>(c));
+                    }
+                    else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    // Chrome traces are in microseconds, fractions keep the nanoseconds
+    std::string formatMicros(int64_t nanos) {
+        return fmt::format("{}.{:03}", nanos / 1000, nanos % 1000);
+    }
+}
+
+std::atomic_bool profiler::detail::enabled = false;
+
+void profiler::setEnabled(bool enabled) {
+    detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+ZoneID profiler::internZone(std::string_view name) {
+    auto& p = Profiler::get();
+    std::lock_guard lock(p.namesMutex);
+    if (auto it = p.ids.find(name); it != p.ids.end()) {
+        return it->second;
+    }
+    auto id = static_cast<ZoneID>(p.names.size());
+    p.names.emplace_back(name);
+    p.ids.emplace(std::string(name), id);
+    return id;
+}
+
+std::string profiler::getZoneName(ZoneID zone) {
+    auto& p = Profiler::get();
+    std::lock_guard lock(p.namesMutex);
+    return zone < p.names.size() ? p.names[zone] : p.names[0];
+}
+
+int64_t profiler::now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - Profiler::get().epoch
+    ).count();
+}
+
+void profiler::record(ZoneID zone, int64_t start, int64_t end) noexcept {
+    auto& p = Profiler::get();
+    // a zone that was still open when profiling was turned off doesn't get a
+    // thread a buffer it would hold on to
+    if (auto buffer = p.buffers.current(isEnabled())) {
+        buffer->write(zone, start, end);
+    }
+}
+
+std::vector<ZoneRecord> profiler::collect() {
+    return Profiler::get().buffers.collect<ZoneRecord>();
+}
+
+void profiler::clear() {
+    Profiler::get().buffers.clear();
+}
+
+std::string profiler::exportChromeTrace() {
+    auto records = profiler::collect();
+
+    auto& p = Profiler::get();
+    std::vector<std::string> names;
+    {
+        std::lock_guard lock(p.namesMutex);
+        names.reserve(p.names.size());
+        for (auto& name : p.names) {
+            std::string escaped;
+            appendEscaped(escaped, name);
+            names.push_back(std::move(escaped));
+        }
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto separate = [&] {
+        if (!first) out += ',';
+        first = false;
+    };
+
+    p.buffers.forEachThread([&](uint32_t thread, std::string const& name) {
+        separate();
+        out += fmt::format(
+            "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":",
+            thread
+        );
+        appendEscaped(out, name.empty() ? fmt::format("Thread {}", thread) : name);
+        out += "}}";
+    });
+
+    for (auto& record : records) {
+        separate();
+        out += "{\"name\":";
+        out += names[record.zone < names.size() ? record.zone : 0];
+        out += fmt::format(
+            ",\"cat\":\"geode\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{},\"dur\":{}}}",
+            record.thread, formatMicros(record.start), formatMicros(record.end - record.start)
+        );
+    }
+    out += "]}";
+    return out;
+}
+
+Result<> profiler::writeChromeTrace(std::filesystem::path const& path) {
+    return file::writeString(path, profiler::exportChromeTrace());
+}
@@ -448,7 +448,7 @@ public:
             : request(std::move(req)), mod(mod), id(id), onComplete(std::move(cb)) {}
 
         void complete(WebResponse res) {
-            WebResponseEvent(mod->getID()).send(res);
+            WebResponseEvent::view(mod->getID()).send(res);
             IDBasedWebResponseEvent(id).send(res);
 
             onComplete(res);
@@ -843,7 +843,9 @@ public:
             r.m_uploadTotal.store(static_cast<size_t>(utotal), relaxed);
             r.m_uploadCurrent.store(static_cast<size_t>(unow), relaxed);
 
-            // Queue the callback in the main thread, make sure to do it only once per frame
+            // Queue the callback in the main thread, make sure to do it only once per frame.
+            // Same priority as the finish callback, which async::spawn queues at High, so
+            // that progress can't be reported after the request has finished
             if (!r.m_progressCallbacks.empty() && !r.m_progressNotifQueued.exchange(true, acq_rel) && !r.m_cancelled.load(relaxed)) {
                 queueInMainThread([req = data->request] {
                     if (req->m_cancelled.load(relaxed)) return;
@@ -852,7 +854,7 @@ public:
                     for (auto& callback : req->m_progressCallbacks) {
                         callback(req->progress());
                     }
-                });
+                }, MainThreadPriority::High);
             }
 
             // Continue as normal
@@ -887,7 +889,7 @@ WebFuture WebRequest::send(std::string method, std::string url, Mod* mod) {
     m_impl->m_url = std::move(url);
     m_impl->m_inInterceptor = true;
 
-    WebRequestInterceptEvent(mod->getID()).send(*this);
+    WebRequestInterceptEvent::view(mod->getID()).send(*this);
     IDBasedWebRequestInterceptEvent(m_impl->m_id).send(*this);
 
     m_impl->m_inInterceptor = false;
@@ -0,0 +1,97 @@
+#include <Geode/loader/BaseFilter.hpp>
+#include "HostTest.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using geode::comm::BaseFilter;
+using geode::comm::BaseFilterEqual;
+using geode::comm::BaseFilterHash;
+using geode::comm::OpaquePortBase;
+
+namespace {
+    // A filter from a mod built before views existed, it only knows how to
+    // compare against itself
+    struct OldFilter : BaseFilter {
+        std::string value;
+
+        explicit OldFilter(std::string value) : value(std::move(value)) {}
+
+        bool operator==(BaseFilter const& other) const noexcept override {
+            auto old = dynamic_cast<OldFilter const*>(&other);
+            return old && old->value == value;
+        }
+        size_t hash() const noexcept override {
+            return std::hash<std::string_view>{}(value);
+        }
+        BaseFilter* clone() const noexcept override {
+            return new OldFilter(value);
+        }
+        OpaquePortBase* getPort() const noexcept override {
+            return nullptr;
+        }
+    };
+
+    // A non-owning view of the same filter, which understands both
+    struct ViewFilter : BaseFilter {
+        std::string_view value;
+
+        explicit ViewFilter(std::string_view value) : value(value) {}
+
+        bool operator==(BaseFilter const& other) const noexcept override {
+            if (auto old = dynamic_cast<OldFilter const*>(&other)) {
+                return old->value == value;
+            }
+            auto view = dynamic_cast<ViewFilter const*>(&other);
+            return view && view->value == value;
+        }
+        size_t hash() const noexcept override {
+            return std::hash<std::string_view>{}(value);
+        }
+        BaseFilter* clone() const noexcept override {
+            return new OldFilter(std::string(value));
+        }
+        OpaquePortBase* getPort() const noexcept override {
+            return nullptr;
+        }
+    };
+
+    // Whichever order the comparator gets its arguments in, the probe decides
+    void argumentOrder() {
+        std::shared_ptr<BaseFilter> key = std::make_shared<OldFilter>("my-mod/event");
+        ViewFilter view("my-mod/event");
+        ViewFilter other("my-mod/other");
+
+        BaseFilterEqual equal;
+        HOST_CHECK(equal(key, &view));
+        HOST_CHECK(equal(&view, key));
+        HOST_CHECK(!equal(key, &other));
+        HOST_CHECK(!equal(&other, key));
+    }
+
+    // The way the event centers look ports up
+    void lookup() {
+        std::unordered_map<std::shared_ptr<BaseFilter>, int, BaseFilterHash, BaseFilterEqual> ports;
+        for (int i = 0; i < 100; ++i) {
+            ports.emplace(std::make_shared<OldFilter>("event-" + std::to_string(i)), i);
+        }
+
+        for (int i = 0; i < 100; ++i) {
+            auto name = "event-" + std::to_string(i);
+            ViewFilter view(name);
+            auto it = ports.find(static_cast<BaseFilter const*>(&view));
+            HOST_CHECK(it != ports.end() && it->second == i);
+        }
+        ViewFilter missing("event-100");
+        HOST_CHECK(ports.find(static_cast<BaseFilter const*>(&missing)) == ports.end());
+    }
+}
+
+int main() {
+    argumentOrder();
+    lookup();
+    std::puts("BaseFilter: ok");
+}
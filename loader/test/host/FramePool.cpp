@@ -0,0 +1,102 @@
+#include <utils/FramePoolBlocks.hpp>
+#include "HostTest.hpp"
+
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace blocks = geode::utils::frame_pool::blocks;
+
+namespace {
+    // Coroutine frames and async state come and go in similar sizes, so once
+    // the pool has warmed up every allocation should reuse a freed block
+    void steadyTraffic() {
+        auto before = blocks::counters();
+        std::vector<std::pair<void*, size_t>> live;
+        for (int round = 0; round < 1000; ++round) {
+            for (size_t size : { 100, 200, 900 }) {
+                live.emplace_back(blocks::allocate(size), size);
+            }
+            for (auto [ptr, size] : live) {
+                blocks::deallocate(ptr, size);
+            }
+            live.clear();
+        }
+        auto after = blocks::counters();
+        HOST_CHECK(after.allocations - before.allocations == 3000);
+        // only the first round of each class misses
+        HOST_CHECK(after.reused - before.reused >= 2997);
+        HOST_CHECK(after.live == before.live);
+        HOST_CHECK(after.oversized == before.oversized);
+    }
+
+    // Sizes are rounded up to their class, so blocks are shared between
+    // sizes of the same class but never handed out for a bigger one
+    void sizeClasses() {
+        HOST_CHECK(blocks::classOf(1) == 0);
+        HOST_CHECK(blocks::classOf(64) == 0);
+        HOST_CHECK(blocks::classOf(65) == 1);
+        HOST_CHECK(blocks::classOf(blocks::MAX_BLOCK_SIZE) == blocks::CLASS_COUNT - 1);
+        for (size_t cls = 0; cls < blocks::CLASS_COUNT; ++cls) {
+            HOST_CHECK(blocks::classOf(blocks::classSize(cls)) == cls);
+        }
+
+        auto ptr = blocks::allocate(70);
+        blocks::deallocate(ptr, 70);
+        HOST_CHECK(blocks::allocate(128) == ptr);
+        blocks::deallocate(ptr, 128);
+        auto bigger = blocks::allocate(129);
+        HOST_CHECK(bigger != ptr);
+        blocks::deallocate(bigger, 129);
+    }
+
+    // Anything past the biggest class goes to the heap
+    void oversized() {
+        auto before = blocks::counters();
+        auto ptr = blocks::allocate(blocks::MAX_BLOCK_SIZE + 1);
+        HOST_CHECK(blocks::counters().oversized == before.oversized + 1);
+        HOST_CHECK(blocks::counters().live == before.live + 1);
+        blocks::deallocate(ptr, blocks::MAX_BLOCK_SIZE + 1);
+        HOST_CHECK(blocks::counters().live == before.live);
+    }
+
+    // Blocks freed on another thread, like the callback of an async task
+    // finishing on a worker, come back to the allocating thread once that
+    // thread's cache is full or it exits
+    void crossThread() {
+        constexpr size_t count = blocks::THREAD_CACHE_LIMIT * 4;
+        // a class none of the other tests use, so its lists start out empty
+        constexpr size_t size = 2000;
+
+        std::vector<void*> allocated;
+        for (size_t i = 0; i < count; ++i) {
+            allocated.push_back(blocks::allocate(size));
+        }
+        std::thread([&] {
+            for (auto ptr : allocated) {
+                blocks::deallocate(ptr, size);
+            }
+        }).join();
+
+        auto before = blocks::counters();
+        std::set<void*> freed(allocated.begin(), allocated.end());
+        std::vector<void*> again;
+        for (size_t i = 0; i < count; ++i) {
+            again.push_back(blocks::allocate(size));
+            HOST_CHECK(freed.contains(again.back()));
+        }
+        HOST_CHECK(blocks::counters().reused - before.reused == count);
+        for (auto ptr : again) {
+            blocks::deallocate(ptr, size);
+        }
+    }
+}
+
+int main() {
+    steadyTraffic();
+    sizeClasses();
+    oversized();
+    crossThread();
+    std::puts("FramePool: ok");
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// The host tests don't use a framework, a failed check ends the test
+#define HOST_CHECK(...) do {                                                   \
+        if (!(__VA_ARGS__)) {                                                  \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__); \
+            std::exit(1);                                                      \
+        }                                                                      \
+    } while (false)
@@ -0,0 +1,138 @@
+#include <Geode/utils/MPSCQueue.hpp>
+#include "HostTest.hpp"
+
+#include <array>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using geode::utils::MPSCQueue;
+
+namespace {
+    // Counts live values, so leaks and double frees show up
+    std::atomic<long> s_live = 0;
+
+    struct Tracked {
+        size_t producer;
+        size_t index;
+
+        Tracked(size_t producer, size_t index) : producer(producer), index(index) { ++s_live; }
+        Tracked(Tracked const& other) : producer(other.producer), index(other.index) { ++s_live; }
+        ~Tracked() { --s_live; }
+    };
+
+    // Several producers push while the consumer keeps draining. Every value
+    // has to arrive exactly once, in the order its producer pushed it
+    template <bool Pooled>
+    void contention() {
+        constexpr size_t producers = 8;
+        constexpr size_t perProducer = 200000;
+
+        {
+            MPSCQueue<Tracked, Pooled> queue;
+            std::array<size_t, producers> next {};
+            std::atomic<size_t> started = 0;
+            size_t received = 0;
+
+            std::vector<std::thread> threads;
+            for (size_t p = 0; p < producers; ++p) {
+                threads.emplace_back([&, p] {
+                    ++started;
+                    while (started.load() < producers) {}
+                    for (size_t i = 0; i < perProducer; ++i) {
+                        queue.push(p, i);
+                    }
+                });
+            }
+
+            while (received < producers * perProducer) {
+                received += queue.drain([&](Tracked& value) {
+                    HOST_CHECK(value.producer < producers);
+                    HOST_CHECK(next[value.producer] == value.index);
+                    next[value.producer] += 1;
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            HOST_CHECK(received == producers * perProducer);
+            HOST_CHECK(queue.empty());
+            HOST_CHECK(queue.drain([](Tracked&) {}) == 0);
+            for (auto count : next) {
+                HOST_CHECK(count == perProducer);
+            }
+        }
+        HOST_CHECK(s_live == 0);
+    }
+
+    // Values pushed by a drain callback wait for the next drain
+    void pushWhileDraining() {
+        MPSCQueue<int> queue;
+        queue.push(1);
+        queue.push(2);
+
+        std::vector<int> seen;
+        auto drained = queue.drain([&](int value) {
+            seen.push_back(value);
+            queue.push(value + 10);
+        });
+        HOST_CHECK(drained == 2);
+        HOST_CHECK((seen == std::vector<int> { 1, 2 }));
+
+        seen.clear();
+        HOST_CHECK(queue.drain([&](int value) { seen.push_back(value); }) == 2);
+        HOST_CHECK((seen == std::vector<int> { 11, 12 }));
+    }
+
+    // A throwing callback drops the rest of the drain without leaking it,
+    // and the queue keeps working afterwards
+    template <bool Pooled>
+    void throwWhileDraining() {
+        {
+            MPSCQueue<Tracked, Pooled> queue;
+            for (size_t i = 0; i < 5; ++i) {
+                queue.push(0, i);
+            }
+
+            size_t calls = 0;
+            try {
+                queue.drain([&](Tracked& value) {
+                    calls += 1;
+                    if (value.index == 2) throw std::runtime_error("stop");
+                });
+                HOST_CHECK(false);
+            }
+            catch (std::runtime_error const&) {}
+            HOST_CHECK(calls == 3);
+            HOST_CHECK(s_live == 0);
+
+            queue.push(1, 0);
+            HOST_CHECK(queue.drain([](Tracked& value) { HOST_CHECK(value.producer == 1); }) == 1);
+        }
+        HOST_CHECK(s_live == 0);
+    }
+
+    // Values never drained are destroyed with the queue
+    void destroyUndrained() {
+        {
+            MPSCQueue<Tracked> queue;
+            for (size_t i = 0; i < 100; ++i) {
+                queue.push(0, i);
+            }
+            HOST_CHECK(s_live == 100);
+        }
+        HOST_CHECK(s_live == 0);
+    }
+}
+
+int main() {
+    contention<false>();
+    contention<true>();
+    pushWhileDraining();
+    throwWhileDraining<false>();
+    throwWhileDraining<true>();
+    destroyUndrained();
+    std::puts("MPSCQueue: ok");
+}
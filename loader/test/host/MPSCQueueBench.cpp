@@ -0,0 +1,88 @@
+#include <Geode/utils/MPSCQueue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using geode::utils::MPSCQueue;
+
+namespace {
+    // What the thread safe QueuedPort used before the lock-free queue
+    template <class T>
+    class LockedQueue {
+        std::mutex m_mutex;
+        std::vector<T> m_items;
+    public:
+        void push(T value) {
+            std::lock_guard lock(m_mutex);
+            m_items.push_back(std::move(value));
+        }
+
+        template <class F>
+        size_t drain(F&& func) {
+            std::vector<T> items;
+            {
+                std::lock_guard lock(m_mutex);
+                items.swap(m_items);
+            }
+            for (auto& item : items) {
+                func(item);
+            }
+            return items.size();
+        }
+    };
+
+    // Pushes from several producers while one consumer drains, and reports
+    // the time per push and the total throughput
+    template <class Queue>
+    void run(char const* name, size_t producers) {
+        constexpr size_t perProducer = 500000;
+
+        Queue queue;
+        std::atomic<size_t> started = 0;
+        std::atomic<long long> pushNanos = 0;
+        size_t received = 0;
+        size_t sum = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&] {
+                ++started;
+                while (started.load() < producers) {}
+                auto pushStart = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < perProducer; ++i) {
+                    queue.push(i);
+                }
+                pushNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - pushStart
+                ).count();
+            });
+        }
+        while (received < producers * perProducer) {
+            received += queue.drain([&](size_t value) { sum += value; });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf(
+            "%-22s %zu producers: %6.1f ns/push, %6.1f M items/s (checksum %zu)\n",
+            name, producers,
+            static_cast<double>(pushNanos.load()) / static_cast<double>(producers * perProducer),
+            static_cast<double>(received) / total / 1e6, sum
+        );
+    }
+}
+
+int main() {
+    for (size_t producers : { 1, 2, 4, 8 }) {
+        run<LockedQueue<size_t>>("mutex + vector", producers);
+        run<MPSCQueue<size_t>>("MPSCQueue", producers);
+        run<MPSCQueue<size_t, true>>("MPSCQueue (pooled)", producers);
+    }
+}
@@ -0,0 +1,144 @@
+#include <Geode/utils/MPSCQueue.hpp>
+#include <loader/MainThreadQueue.hpp>
+#include "HostTest.hpp"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using geode::utils::MPSCQueue;
+using geode::main_thread::PendingTasks;
+using geode::main_thread::PRIORITY_COUNT;
+
+// Submitting to the main thread from several threads at once, the way the
+// loader's queueInMainThread does: a pooled queue taken once per frame into
+// the loader's per-priority lists, of which only part runs each frame.
+// Whatever is left over has to stay ahead of what is submitted later, so
+// each thread's functions still run in the order that thread queued them
+namespace {
+    constexpr size_t PRIORITIES = PRIORITY_COUNT;
+
+    struct Task {
+        std::function<void()> func;
+        size_t priority;
+    };
+
+    struct MainThread {
+        MPSCQueue<Task, true> queue;
+        PendingTasks<Task> pending;
+
+        // Runs every high priority function, and about `budget` of the
+        // others, like a frame that runs out of time
+        size_t frame(size_t budget) {
+            pending.take(queue, [](size_t) {});
+            size_t runs = 0;
+            return pending.runFrame([&](Task& task) {
+                task.func();
+                runs += 1;
+            }, [&] {
+                return runs < budget;
+            });
+        }
+
+        bool idle() const {
+            return pending.empty() && queue.empty();
+        }
+    };
+
+    // High priority functions ignore the budget, the others get at least
+    // one run each per frame
+    void budget() {
+        MainThread main;
+        std::vector<size_t> order;
+        for (size_t i = 0; i < 12; ++i) {
+            auto priority = i % PRIORITIES;
+            main.queue.push(Task { [&order, i] { order.push_back(i); }, priority });
+        }
+
+        HOST_CHECK(main.frame(0) == 6);
+        HOST_CHECK((order == std::vector<size_t> { 0, 3, 6, 9, 1, 2 }));
+        HOST_CHECK(main.pending.size(0) == 0);
+        HOST_CHECK(main.pending.size(1) == 3);
+        HOST_CHECK(main.pending.size(2) == 3);
+
+        // new functions queue up behind the ones left over
+        main.queue.push(Task { [&order] { order.push_back(100); }, 1 });
+        order.clear();
+        HOST_CHECK(main.frame(2) == 3);
+        HOST_CHECK((order == std::vector<size_t> { 4, 7, 5 }));
+        HOST_CHECK(main.pending.size(1) == 2);
+
+        order.clear();
+        while (!main.idle()) {
+            main.frame(0);
+        }
+        HOST_CHECK((order == std::vector<size_t> { 10, 8, 100, 11 }));
+    }
+
+    void stress(size_t budget) {
+        constexpr size_t producers = 4;
+        constexpr size_t perProducer = 50000;
+
+        MainThread main;
+        // the index of the next function of each thread and priority, only
+        // touched by the functions, which all run on this thread
+        std::array<std::array<size_t, PRIORITIES>, producers> next {};
+        for (auto& priorities : next) {
+            for (size_t priority = 0; priority < PRIORITIES; ++priority) {
+                priorities[priority] = priority;
+            }
+        }
+        size_t ran = 0;
+        std::atomic<size_t> started = 0;
+
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                ++started;
+                while (started.load() < producers) {}
+                for (size_t i = 0; i < perProducer; ++i) {
+                    auto priority = i % PRIORITIES;
+                    main.queue.push(Task { [&, p, priority, i] {
+                        HOST_CHECK(next[p][priority] == i);
+                        next[p][priority] = i + PRIORITIES;
+                        ran += 1;
+                    }, priority });
+                }
+            });
+        }
+
+        std::atomic_bool producing = true;
+        std::thread joiner([&] {
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            producing = false;
+        });
+
+        size_t frames = 0;
+        while (producing || !main.idle()) {
+            main.frame(budget);
+            frames += 1;
+        }
+        joiner.join();
+
+        HOST_CHECK(ran == producers * perProducer);
+        for (size_t p = 0; p < producers; ++p) {
+            for (size_t priority = 0; priority < PRIORITIES; ++priority) {
+                HOST_CHECK(next[p][priority] >= perProducer);
+                HOST_CHECK(next[p][priority] < perProducer + PRIORITIES);
+            }
+        }
+        std::printf("main thread queue: %zu functions in %zu frames, budget %zu\n", ran, frames, budget);
+    }
+}
+
+int main() {
+    budget();
+    // plenty of budget, and so little that most functions wait a few frames
+    stress(100000);
+    stress(16);
+    std::puts("MainThreadQueue: ok");
+}
@@ -0,0 +1,86 @@
+#include <Geode/loader/PortReceivers.hpp>
+#include "HostTest.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using geode::comm::ReceiverHandle;
+namespace receivers = geode::comm::receivers;
+
+namespace {
+    struct Receiver {
+        int m_priority;
+        ReceiverHandle m_handle;
+    };
+
+    using Vector = std::vector<Receiver>;
+    using Iterator = Vector::iterator;
+
+    Vector make(size_t count, int priorities) {
+        Vector ret;
+        for (size_t i = 0; i < count; ++i) {
+            int priority = static_cast<int>(i % priorities);
+            ret.insert(receivers::insertPosition(ret, priority), Receiver{priority, i + 1});
+        }
+        return ret;
+    }
+
+    // Sorted by priority, and by handle within the same priority
+    void ordering() {
+        auto list = make(1000, 7);
+        HOST_CHECK(std::is_sorted(list.begin(), list.end(), [](auto const& a, auto const& b) {
+            return a.m_priority < b.m_priority || (a.m_priority == b.m_priority && a.m_handle < b.m_handle);
+        }));
+        for (ReceiverHandle handle = 1; handle <= 1000; ++handle) {
+            auto it = receivers::find(list, handle);
+            HOST_CHECK(it != list.end() && it->m_handle == handle);
+        }
+        HOST_CHECK(receivers::find(list, 1001) == list.end());
+    }
+
+    // Older mods sort pending receivers in with std::sort, which may mix up
+    // the handles of the same priority
+    void unsortedBand() {
+        auto list = make(200, 2);
+        std::reverse(list.begin(), list.begin() + 100);
+        for (ReceiverHandle handle = 1; handle <= 200; ++handle) {
+            auto it = receivers::find(list, handle);
+            HOST_CHECK(it != list.end() && it->m_handle == handle);
+        }
+    }
+
+    void pendingRemovals() {
+        auto list = make(100, 3);
+        std::vector<Iterator> toRemove;
+        receivers::PendingRemovals<Iterator> removed(toRemove);
+        HOST_CHECK(!removed.contains(list.begin()));
+
+        // appended out of order, like older mods do
+        toRemove.push_back(list.begin() + 50);
+        toRemove.push_back(list.begin() + 10);
+        HOST_CHECK(removed.contains(list.begin() + 10));
+        HOST_CHECK(removed.contains(list.begin() + 50));
+        HOST_CHECK(!removed.contains(list.begin() + 11));
+        toRemove.push_back(list.begin() + 5);
+        toRemove.push_back(list.begin() + 10);
+        HOST_CHECK(removed.contains(list.begin() + 5));
+
+        auto kept = std::vector<ReceiverHandle>();
+        for (size_t i = 0; i < list.size(); ++i) {
+            if (i != 5 && i != 10 && i != 50) kept.push_back(list[i].m_handle);
+        }
+        receivers::erase(list, toRemove);
+        HOST_CHECK(toRemove.empty());
+        HOST_CHECK(list.size() == kept.size());
+        for (size_t i = 0; i < list.size(); ++i) {
+            HOST_CHECK(list[i].m_handle == kept[i]);
+        }
+    }
+}
+
+int main() {
+    ordering();
+    unsortedBand();
+    pendingRemovals();
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <Geode/loader/PortReceivers.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using geode::comm::ReceiverHandle;
+namespace receivers = geode::comm::receivers;
+
+namespace {
+    struct Receiver {
+        int m_priority;
+        ReceiverHandle m_handle;
+    };
+
+    using Vector = std::vector<Receiver>;
+    using Iterator = Vector::iterator;
+
+    Vector make(size_t count, int priorities) {
+        Vector ret;
+        for (size_t i = 0; i < count; ++i) {
+            int priority = static_cast<int>(i % priorities);
+            ret.insert(receivers::insertPosition(ret, priority), Receiver{priority, i + 1});
+        }
+        return ret;
+    }
+
+    template <class F>
+    double fastest(F&& func) {
+        auto best = std::chrono::nanoseconds::max();
+        for (int i = 0; i < 5; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            func();
+            best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+        }
+        return static_cast<double>(best.count());
+    }
+
+    // Finding a receiver among many of the same priority, like node
+    // listeners. This grows with log n, a linear search would grow with n
+    void find(size_t count) {
+        constexpr size_t lookups = 20000;
+        auto list = make(count, 1);
+        std::mt19937 rng(count);
+        std::vector<ReceiverHandle> handles(lookups);
+        for (auto& handle : handles) {
+            handle = rng() % count + 1;
+        }
+        size_t found = 0;
+        auto time = fastest([&] {
+            for (auto handle : handles) {
+                found += receivers::find(list, handle) != list.end();
+            }
+        });
+        std::printf("find, %6zu receivers:          %8.1f ns/lookup (found %zu)\n", count, time / lookups, found);
+    }
+
+    // Checking every receiver against the pending removals while sending
+    void sendWithRemovals(size_t removals) {
+        constexpr size_t count = 4096;
+        auto list = make(count, 1);
+        std::vector<Iterator> toRemove;
+        for (size_t i = 0; i < removals; ++i) {
+            toRemove.push_back(list.begin() + (i * 7919) % list.size());
+        }
+        size_t skipped = 0;
+        auto time = fastest([&] {
+            receivers::PendingRemovals<Iterator> removed(toRemove);
+            for (auto it = list.begin(); it != list.end(); ++it) {
+                skipped += removed.contains(it);
+            }
+        });
+        std::printf("send, %6zu pending removals:   %8.1f ns/receiver (skipped %zu)\n", removals, time / count, skipped);
+    }
+
+    // Inserting still moves every receiver after the position, so this
+    // grows with n
+    void insert(size_t count) {
+        constexpr size_t inserts = 1000;
+        auto base = make(count, 4);
+        auto time = fastest([&] {
+            auto list = base;
+            for (size_t i = 0; i < inserts; ++i) {
+                int priority = static_cast<int>(i % 4);
+                list.insert(receivers::insertPosition(list, priority), Receiver{priority, count + i + 1});
+            }
+        });
+        std::printf("insert, %6zu receivers:        %8.1f ns/insert\n", count, time / inserts);
+    }
+}
+
+int main() {
+    for (size_t count : { 1024, 8192, 65536 }) {
+        find(count);
+    }
+    for (size_t removals : { 16, 256, 1024 }) {
+        sendWithRemovals(removals);
+    }
+    for (size_t count : { 1024, 8192, 65536 }) {
+        insert(count);
+    }
+}
@@ -0,0 +1,127 @@
+#include <utils/ProfilerBuffers.hpp>
+#include "HostTest.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using geode::utils::profiler::ZoneBuffers;
+using geode::utils::profiler::ZoneID;
+
+namespace {
+    struct Record {
+        ZoneID zone;
+        uint32_t thread;
+        int64_t start;
+        int64_t end;
+    };
+
+    ZoneBuffers s_buffers([] { return std::string("host"); });
+
+    // Threads only get a buffer once they record with allocation allowed
+    void lazyAllocation() {
+        HOST_CHECK(s_buffers.threadCount() == 0);
+        std::thread([] {
+            HOST_CHECK(s_buffers.current(false) == nullptr);
+        }).join();
+        HOST_CHECK(s_buffers.current(false) == nullptr);
+        HOST_CHECK(s_buffers.threadCount() == 0);
+
+        auto buffer = s_buffers.current(true);
+        HOST_CHECK(buffer != nullptr);
+        HOST_CHECK(buffer->name == "host");
+        HOST_CHECK(s_buffers.current(false) == buffer);
+        HOST_CHECK(s_buffers.threadCount() == 1);
+    }
+
+    // Only the newest BUFFER_SIZE zones are kept, and clear drops the rest
+    void wrapAround() {
+        auto buffer = s_buffers.current(true);
+        auto count = ZoneBuffers::BUFFER_SIZE + 100;
+        for (size_t i = 0; i < count; ++i) {
+            buffer->write(1, i, i + 1);
+        }
+        auto records = s_buffers.collect<Record>();
+        HOST_CHECK(records.size() == ZoneBuffers::BUFFER_SIZE);
+        HOST_CHECK(records.front().start == 100);
+        HOST_CHECK(records.back().start == static_cast<int64_t>(count - 1));
+
+        s_buffers.clear();
+        HOST_CHECK(s_buffers.collect<Record>().empty());
+        buffer->write(1, 5, 6);
+        HOST_CHECK(s_buffers.collect<Record>().size() == 1);
+        s_buffers.clear();
+    }
+
+    // An exited thread's zones can be collected until the next clear, which
+    // frees its buffer
+    void reclaimExited() {
+        auto before = s_buffers.threadCount();
+        std::thread([] {
+            s_buffers.current(true)->write(2, 10, 20);
+        }).join();
+        HOST_CHECK(s_buffers.threadCount() == before + 1);
+
+        auto records = s_buffers.collect<Record>();
+        HOST_CHECK(records.size() == 1);
+        HOST_CHECK(records[0].zone == 2);
+        auto thread = records[0].thread;
+
+        s_buffers.clear();
+        HOST_CHECK(s_buffers.threadCount() == before);
+        s_buffers.forEachThread([&](uint32_t id, std::string const&) {
+            HOST_CHECK(id != thread);
+        });
+
+        // the ids of reclaimed threads aren't handed out again
+        std::thread([&] {
+            HOST_CHECK(s_buffers.current(true)->thread > thread);
+        }).join();
+        s_buffers.clear();
+        HOST_CHECK(s_buffers.threadCount() == before);
+    }
+
+    // Collecting while threads keep recording, and wrapping around, never
+    // returns a torn zone. This is the case to run under TSan
+    void collectWhileRecording() {
+        constexpr size_t threads = 3;
+        constexpr int64_t perThread = 200000;
+
+        std::atomic_bool stop = false;
+        std::vector<std::thread> writers;
+        for (size_t t = 0; t < threads; ++t) {
+            writers.emplace_back([&, t] {
+                auto buffer = s_buffers.current(true);
+                auto zone = static_cast<ZoneID>(t + 1);
+                for (int64_t i = 0; i < perThread && !stop; ++i) {
+                    // every field is derived from the zone, so a mix of two
+                    // writes shows up
+                    buffer->write(zone, i * zone, i * zone + zone);
+                }
+            });
+        }
+
+        for (size_t round = 0; round < 50; ++round) {
+            for (auto& record : s_buffers.collect<Record>()) {
+                HOST_CHECK(record.zone >= 1 && record.zone <= threads);
+                HOST_CHECK(record.start % record.zone == 0);
+                HOST_CHECK(record.end == record.start + record.zone);
+            }
+        }
+        stop = true;
+        for (auto& writer : writers) {
+            writer.join();
+        }
+
+        s_buffers.clear();
+        HOST_CHECK(s_buffers.threadCount() == 1);
+    }
+}
+
+int main() {
+    lazyAllocation();
+    wrapAround();
+    reclaimExited();
+    collectWhileRecording();
+    std::puts("Profiler: ok");
+}
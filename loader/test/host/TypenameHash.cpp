@@ -0,0 +1,48 @@
+#include <Geode/utils/hash.hpp>
+#include "HostTest.hpp"
+
+#include <functional>
+#include <string_view>
+#include <typeinfo>
+
+using geode::typenameHash;
+
+// Events are identified by the hash of their marker type's name, which is
+// computed on every send. It has to stay the same value older mods compute.
+// How much the cache saves is measured by TypenameHashBench
+namespace {
+    struct Short {};
+
+    template <class T>
+    struct Wrap {};
+
+    // A marker whose mangled name is a few thousand characters long
+    template <int N>
+    struct Nest {
+        using Type = Wrap<typename Nest<N - 1>::Type>;
+    };
+    template <>
+    struct Nest<0> {
+        using Type = Short;
+    };
+    using Long = Nest<400>::Type;
+
+    template <class T>
+    size_t uncached() {
+        return std::hash<std::string_view>{}(typeid(T).name());
+    }
+
+    // The cached value is the one older headers hash every time
+    void value() {
+        HOST_CHECK(std::string_view(typeid(Long).name()).size() > 2000);
+        HOST_CHECK(typenameHash<Short>() == uncached<Short>());
+        HOST_CHECK(typenameHash<Long>() == uncached<Long>());
+        HOST_CHECK(typenameHash<Long>() == typenameHash<Long>());
+        HOST_CHECK(typenameHash<Short>() != typenameHash<Long>());
+    }
+}
+
+int main() {
+    value();
+    std::puts("TypenameHash: ok");
+}
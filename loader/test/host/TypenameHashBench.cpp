@@ -0,0 +1,71 @@
+#include <Geode/utils/hash.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string_view>
+#include <typeinfo>
+
+using geode::typenameHash;
+
+namespace {
+    struct Short {};
+
+    template <class T>
+    struct Wrap {};
+
+    // A marker whose mangled name is a few thousand characters long
+    template <int N>
+    struct Nest {
+        using Type = Wrap<typename Nest<N - 1>::Type>;
+    };
+    template <>
+    struct Nest<0> {
+        using Type = Short;
+    };
+    using Long = Nest<400>::Type;
+
+    // Keeps the loops from being optimized out
+    size_t volatile s_sink = 0;
+
+    template <class F>
+    double fastest(F&& func) {
+        auto best = std::chrono::nanoseconds::max();
+        for (int i = 0; i < 5; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            func();
+            best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+        }
+        return static_cast<double>(best.count());
+    }
+
+    // Events hash their marker's name on every send. Once cached, a long
+    // name should cost the same as a short one, and far less than hashing it
+    template <class T>
+    void cached(char const* name) {
+        constexpr size_t calls = 1000000;
+        auto time = fastest([&] {
+            for (size_t i = 0; i < calls; ++i) {
+                s_sink = s_sink + typenameHash<T>();
+            }
+        });
+        std::printf("typenameHash, %-5s name:   %8.2f ns/call\n", name, time / calls);
+    }
+
+    void rehashed() {
+        constexpr size_t calls = 10000;
+        auto time = fastest([&] {
+            for (size_t i = 0; i < calls; ++i) {
+                s_sink = s_sink + std::hash<std::string_view>{}(typeid(Long).name());
+            }
+        });
+        std::printf("hashing the long name:      %8.2f ns/call\n", time / calls);
+    }
+}
+
+int main() {
+    cached<Short>("short");
+    cached<Long>("long");
+    rehashed();
+}
@@ -2,6 +2,7 @@
 #include <Geode/loader/ModEvent.hpp>
 #include <Geode/utils/cocos.hpp>
 #include <chrono>
+#include <thread>
 #include "../dependency/main.hpp"
 #include "Geode/utils/general.hpp"
 #include <Geode/utils/VMTHookManager.hpp>
@@ -54,6 +55,9 @@ $on_mod(Loaded) {
     Dispatch<int&>("test").send(value);
     geode::log::info("Value after dispatch: {}", value);
     Dispatch<int>("test2").send(7);
+    auto sender = Dispatch<int>("test2").sender();
+    sender.send(8);
+    Dispatch<int>::view("test2").send(9);
     Dispatch<float>("test").send(9);
     value = -35;
     geode::log::info("Value before dispatch: {}", value);
@@ -71,6 +75,202 @@ $on_mod(Loaded) {
     }).leak();
 }
 
+// Batched sends
+struct NumberEvent : Event<NumberEvent, bool(int)> {
+    using Event::Event;
+};
+
+static void checkEventSendBatch() {
+    std::vector<NumberEvent::Payload> payloads { {1}, {2}, {3} };
+
+    std::vector<int> received;
+    auto handle = NumberEvent().listen([&](int n) {
+        received.push_back(n);
+        return n == 2;
+    });
+    auto stopped = NumberEvent().sendBatch(payloads);
+    if (received != std::vector{1, 2, 3} || stopped != 1) {
+        log::error("Batched send skipped payloads or miscounted the stopped ones");
+    }
+
+    // batch listeners get the whole batch first, and can stop all of it
+    size_t batchSize = 0;
+    auto batchHandle = NumberEvent().listenBatch([&](std::span<NumberEvent::Payload> batch) {
+        batchSize = batch.size();
+        return true;
+    });
+    received.clear();
+    stopped = NumberEvent().sendBatch(payloads);
+    if (batchSize != payloads.size() || !received.empty() || stopped != payloads.size()) {
+        log::error("Batch listener did not receive or stop the whole batch");
+    }
+}
+
+// Mods built against older headers inline their own send, which walks
+// m_receivers and only sorts pending adds in once it's done. Receivers added
+// through the current header have to be reachable from it
+struct BaselinePort : comm::Port<CopyableFunction<bool(int)>> {
+    bool baselineSend(int value) {
+        m_sending++;
+        bool ret = false;
+        for (auto& callable : m_receivers) {
+            if (std::find_if(m_toRemove.begin(), m_toRemove.end(), [&](auto& it) {
+                return it->m_handle == callable.m_handle;
+            }) != m_toRemove.end()) continue;
+            if (callable.call(value)) {
+                ret = true;
+                break;
+            }
+        }
+        m_sending--;
+        if (m_sending == 0) {
+            std::sort(m_toRemove.rbegin(), m_toRemove.rend());
+            for (auto& it : m_toRemove) {
+                m_receivers.erase(it);
+            }
+            m_toRemove.clear();
+            m_receivers.insert(m_receivers.end(), std::make_move_iterator(m_toAdd.begin()), std::make_move_iterator(m_toAdd.end()));
+            m_toAdd.clear();
+            std::sort(m_receivers.begin(), m_receivers.end(), [](auto& a, auto& b) {
+                return a.m_priority < b.m_priority;
+            });
+        }
+        return ret;
+    }
+};
+
+static void checkBaselineSend() {
+    BaselinePort port;
+    std::vector<int> order;
+    auto receiver = [&](int n) {
+        return [&order, n](int) { order.push_back(n); return false; };
+    };
+    auto first = port.addReceiver(receiver(1), 0);
+    port.addReceiver(receiver(2), -1);
+    port.addReceiver(receiver(3), 0);
+    comm::ReceiverHandle added = 0;
+    port.addReceiver([&](int) {
+        if (!added) {
+            port.removeReceiver(first);
+            added = port.addReceiver(receiver(5), -5);
+        }
+        order.push_back(4);
+        return false;
+    }, -3);
+
+    port.baselineSend(0);
+    if (order != std::vector{4, 2, 3}) {
+        log::error("Baseline send missed receivers added by the current header");
+    }
+    order.clear();
+    port.baselineSend(0);
+    if (order != std::vector{5, 4, 2, 3} || port.getReceiverCount() != 4) {
+        log::error("Baseline send didn't flush receivers added while sending");
+    }
+}
+
+// Ports built on Port have their own members right after it, which older
+// mods read at the offsets they were compiled with. Port can't gain members
+// without moving those
+template <class Callable, template <class> class Container>
+struct BaselinePortLayout {
+    std::vector<Container<Callable>> m_receivers;
+    std::vector<typename std::vector<Container<Callable>>::iterator> m_toRemove;
+    std::vector<Container<Callable>> m_toAdd;
+    size_t m_nextID;
+    size_t m_sending;
+};
+struct BaselineOncePortLayout : BaselinePortLayout<CopyableFunction<bool(int)>, comm::PortCallableMove> {
+    bool m_sent;
+};
+struct BaselineThreadSafeOncePortLayout {
+    asp::PtrSwap<std::vector<comm::PortCallableMove<CopyableFunction<bool(int)>>>> m_receivers;
+    std::atomic_flag m_sent;
+};
+
+static void checkBaselineOncePort() {
+    comm::OncePort<CopyableFunction<bool(int)>> port;
+    comm::OncePort<CopyableFunction<bool(int)>, true> threadSafePort;
+    static_assert(sizeof(port) == sizeof(BaselineOncePortLayout));
+    static_assert(sizeof(threadSafePort) == sizeof(BaselineThreadSafeOncePortLayout));
+
+    int calls = 0;
+    port.addReceiver([&](int) { calls += 1; return false; });
+    threadSafePort.addReceiver([&](int) { calls += 1; return false; });
+    auto baseline = reinterpret_cast<BaselineOncePortLayout*>(&port);
+    auto threadSafeBaseline = reinterpret_cast<BaselineThreadSafeOncePortLayout*>(&threadSafePort);
+    if (baseline->m_receivers.size() != 1 || threadSafeBaseline->m_receivers.load()->size() != 1) {
+        log::error("Baseline once port doesn't see the receivers added by the current header");
+    }
+
+    port.send(0);
+    threadSafePort.send(0);
+    if (calls != 2 || !baseline->m_sent || !threadSafeBaseline->m_sent.test()) {
+        log::error("Baseline once port doesn't see that the current header sent it");
+    }
+}
+
+struct BaselineQueuedPortLayout : BaselinePortLayout<CopyableFunction<bool(int)>, comm::PortCallableCopy> {
+    std::vector<CopyableFunction<void()>> m_queue;
+};
+struct BaselineThreadSafeQueuedOncePortLayout {
+    asp::PtrSwap<std::vector<comm::PortCallableMove<CopyableFunction<bool(int)>>>> m_receivers;
+    asp::PtrSwap<std::vector<CopyableFunction<void()>>> m_queue;
+    std::atomic_flag m_sent;
+};
+
+// Events queued by older mods go into the queue they know about, and are
+// delivered by a flush through the current header
+static void checkBaselineQueuedPort() {
+    comm::QueuedPort<CopyableFunction<bool(int)>> port;
+    comm::QueuedOncePort<CopyableFunction<bool(int)>, true> threadSafePort;
+    static_assert(sizeof(port) == sizeof(BaselineQueuedPortLayout));
+
+    std::vector<int> received;
+    port.addReceiver([&](int value) { received.push_back(value); return false; });
+    threadSafePort.addReceiver([&](int value) { received.push_back(value); return false; });
+    auto baseline = reinterpret_cast<BaselineQueuedPortLayout*>(&port);
+    auto threadSafeBaseline = reinterpret_cast<BaselineThreadSafeQueuedOncePortLayout*>(&threadSafePort);
+
+    port.send(1);
+    if (baseline->m_queue.size() != 1) {
+        log::error("Baseline queued port doesn't see events queued by the current header");
+    }
+    threadSafeBaseline->m_queue.rcu([&](auto const& ptr) {
+        auto queue = asp::make_shared<std::vector<CopyableFunction<void()>>>(*ptr.get());
+        queue->push_back([&] { received.push_back(2); });
+        return queue;
+    });
+    threadSafePort.send(3);
+    if (!threadSafeBaseline->m_sent.test()) {
+        log::error("Baseline queued once port doesn't see that the current header sent it");
+    }
+
+    port.flush();
+    threadSafePort.flush();
+    if (received != std::vector{1, 2, 3}) {
+        log::error("Flushing queued ports missed events queued with the baseline layout");
+    }
+}
+
+$on_mod(Loaded) {
+    checkBaselineSend();
+    checkBaselineOncePort();
+    checkBaselineQueuedPort();
+    checkEventSendBatch();
+
+#ifdef GEODE_EVENT_PROFILER
+    auto stats = comm::profiler::snapshot();
+    for (auto& receiver : stats.receivers) {
+        if (receiver.mod != Mod::get()) continue;
+        log::info(
+            "{}: {} calls, {}ns total, {}ns max", receiver.eventType, receiver.calls,
+            receiver.totalTime.count(), receiver.maxTime.count()
+        );
+    }
+#endif
+}
+
 // Coroutines
 #include <Geode/utils/coro.hpp>
 auto advanceFrame() {
@@ -106,6 +306,181 @@ $on_mod(Loaded) {
     }
 }
 
+// Task progress is coalesced to one delivery per frame, and the maps below
+// fuse into a single stage listening to the spawned task. Coalescing only
+// ever drops older updates, so the deliveries have to be fewer than the
+// updates and in the order they were posted. Progress still pending when the
+// task finishes is dropped, so there may be none at all. Only the handle
+// of the next major version delivers Task events
+#ifdef GEODE_TASK_HANDLE_V2
+$on_mod(Loaded) {
+    constexpr int updates = 100000;
+
+    struct Progress {
+        size_t deliveries = 0;
+        int last = -1;
+        bool ordered = true;
+    };
+    auto state = std::make_shared<Progress>();
+
+    auto [task, finish, progress, hasBeenCancelled] = Task<int, int>::spawn("Progress stress");
+    task.map([](int* value) { return *value + 1; }, [](int* p) { return *p; })
+        .map([](int* value) { return *value * 2; }, [](int* p) { return *p; })
+        .listen(
+            [state](int* value) {
+                if (*value != 42) {
+                    log::error("Fused task maps finished with {} instead of 42", *value);
+                }
+                if (state->deliveries >= updates || !state->ordered) {
+                    log::error(
+                        "Task progress wasn't coalesced: {} deliveries for {} updates, in order: {}",
+                        state->deliveries, updates, state->ordered
+                    );
+                }
+            },
+            [state](int* p) {
+                state->deliveries += 1;
+                state->ordered &= *p > state->last;
+                state->last = *p;
+            }
+        );
+
+    std::thread([finish = std::move(finish), progress = std::move(progress)] {
+        for (int i = 0; i < updates; ++i) {
+            progress(i);
+        }
+        finish(20);
+    }).detach();
+}
+#endif
+
+// Zone profiler: record some nested zones and export them as a Chrome trace,
+// which can be opened in Perfetto. Every iteration has to be recorded inside
+// the outer zone, and nothing while the profiler is off
+#include <Geode/utils/timer.hpp>
+$on_mod(Loaded) {
+    auto wasEnabled = profiler::isEnabled();
+    profiler::setEnabled(false);
+    for (int i = 0; i < 10; ++i) {
+        GEODE_PROFILE_ZONE("Profiler test disabled");
+    }
+    profiler::setEnabled(true);
+    {
+        GEODE_PROFILE_ZONE("Profiler test");
+        for (int i = 0; i < 100; ++i) {
+            GEODE_PROFILE_ZONE("Profiler test iteration");
+        }
+    }
+    profiler::setEnabled(wasEnabled);
+
+    auto records = profiler::collect();
+    auto outer = std::find_if(records.begin(), records.end(), [](auto const& record) {
+        return profiler::getZoneName(record.zone) == "Profiler test";
+    });
+    size_t iterations = 0, disabled = 0;
+    for (auto& record : records) {
+        auto name = profiler::getZoneName(record.zone);
+        if (name == "Profiler test disabled") disabled += 1;
+        if (name == "Profiler test iteration" && outer != records.end() && record.thread == outer->thread &&
+            record.start >= outer->start && record.end <= outer->end) {
+            iterations += 1;
+        }
+    }
+    if (outer == records.end() || iterations != 100 || disabled != 0) {
+        log::error("Profiler recorded {} of 100 nested zones and {} zones while disabled", iterations, disabled);
+    }
+
+    auto path = Mod::get()->getSaveDir() / "trace.json";
+    if (auto res = profiler::writeChromeTrace(path)) {
+        log::info("Wrote {} profiler zones to {}", records.size(), path);
+    }
+    else {
+        log::error("Failed to write profiler trace: {}", res.unwrapErr());
+    }
+}
+
+// Startup timeline: by the time textures are loaded startup is over, check
+// that every phase ran for this mod, and that the spans nest the way the
+// phases are documented to
+#include <Geode/loader/StartupTimeline.hpp>
+$on_game(TexturesLoaded) {
+    if (!startup::isComplete()) {
+        log::error("Startup timeline isn't complete after textures loaded");
+        return;
+    }
+    std::string_view id = Mod::get()->getID().view();
+    auto timeline = startup::getTimeline();
+    auto find = [&](startup::Phase phase) {
+        return std::find_if(timeline.begin(), timeline.end(), [&](auto const& span) {
+            return span.phase == phase && span.mod == id;
+        });
+    };
+    for (auto phase : {
+        startup::Phase::ParseMetadata, startup::Phase::BuildModGraph, startup::Phase::Unzip,
+        startup::Phase::LoadBinary, startup::Phase::LoadedHandlers, startup::Phase::UpdateResources,
+    }) {
+        if (find(phase) == timeline.end()) {
+            log::error("Startup timeline is missing {} for {}", startup::phaseName(phase), id);
+        }
+    }
+
+    auto sorted = std::is_sorted(timeline.begin(), timeline.end(), [](auto const& a, auto const& b) {
+        return a.start < b.start;
+    });
+    if (!sorted || timeline.empty() ||
+        timeline.back().start - timeline.front().start > startup::getTotalTime()) {
+        log::error("Startup timeline isn't ordered, or outlasts the total startup time");
+    }
+
+    auto binary = find(startup::Phase::LoadBinary);
+    auto handlers = find(startup::Phase::LoadedHandlers);
+    if (binary != timeline.end() && handlers != timeline.end() && (
+        handlers->start < binary->start ||
+        handlers->start + handlers->duration > binary->start + binary->duration ||
+        startup::getPhaseTime(startup::Phase::LoadedHandlers, id) > startup::getPhaseTime(startup::Phase::LoadBinary, id)
+    )) {
+        log::error("Loaded handlers of {} ran outside of loading its binary", id);
+    }
+}
+
+// Incremental unzip: every file of this mod's package should be extracted,
+// match the checksum the zip has for it, and be listed with that checksum in
+// the extraction manifest, so that the next launch can skip it. Binaries are
+// skipped, patchless platforms swap this mod's for a patched one and the ones
+// for other platforms aren't extracted at all
+$on_mod(Loaded) {
+    auto mod = Mod::get();
+    auto unzip = file::Unzip::create(mod->getPackagePath());
+    if (!unzip) {
+        log::error("Failed to open own package: {}", unzip.unwrapErr());
+        return;
+    }
+    auto manifest = file::readJson(mod->getTempDir() / "extracted.json");
+    if (!manifest) {
+        log::error("Failed to read the extraction manifest: {}", manifest.unwrapErr());
+        return;
+    }
+    std::unordered_map<std::string, int64_t> listed;
+    if (auto entries = manifest.unwrap()["entries"].asArray()) {
+        for (auto& entry : entries.unwrap()) {
+            listed[entry["path"].asString().unwrapOr("")] = entry["crc"].asInt().unwrapOr(-1);
+        }
+    }
+
+    for (auto& entry : unzip.unwrap().getEntryInfo()) {
+        auto name = utils::string::pathToString(entry.path);
+        if (entry.isDirectory || (!entry.path.has_parent_path() && name.starts_with(mod->getID().view()))) continue;
+        auto crc = file::readCRC32(mod->getTempDir() / entry.path);
+        if (!crc || crc.unwrap() != entry.crc32) {
+            log::error("Extracted file {} is missing or doesn't match its zip entry", name);
+        }
+        auto it = listed.find(name);
+        if (it == listed.end() || it->second != entry.crc32) {
+            log::error("Extracted file {} isn't in the extraction manifest with its checksum", name);
+        }
+    }
+}
+
 #include <Geode/modify/MenuLayer.hpp>
 struct $modify(MenuLayer) {
     bool init() {